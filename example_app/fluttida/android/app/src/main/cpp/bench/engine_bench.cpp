@@ -0,0 +1,173 @@
+// Engine driver: N concurrent transfers through curl_engine_submit on each backend.
+//
+// Every transfer is a separate easy handle submitted at once, so with a server that
+// holds its responses (keepalive_server.py's /delay/<lo>-<hi>) all N are in flight on
+// the loop thread together and complete one by one. The poll backend walks every
+// transfer on each wakeup, the epoll backend only the ready sockets; the difference
+// shows in the process CPU time per transfer. The engine is a process-wide singleton whose backend is fixed at the
+// first submit, so each backend/N pair runs in its own forked child.
+//
+//   python3 bench/keepalive_server.py 8080 &
+//   cmake -S . -B build -DCMAKE_BUILD_TYPE=Release -DNATIVEHTTP_BUILD_BENCH=ON
+//   cmake --build build && ./build/engine_bench -n 1000,3000 http://localhost:8080/delay/500-2500
+//
+// HTTPS works too (-c CA_BUNDLE and a server started with CERT KEY). Raise
+// `ulimit -n` above N on both sides.
+
+#include "curl_engine.h"
+#include "native_api.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#include <curl/curl.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+size_t discard(char*, size_t size, size_t nmemb, void*) {
+    return size * nmemb;
+}
+
+double cpu_ms() {
+    rusage ru{};
+    getrusage(RUSAGE_SELF, &ru);
+    return (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1e3 + (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e3;
+}
+
+// One backend/N run in the calling (child) process, which it exits
+[[noreturn]] void run(EngineBackend backend, const char* name, int transfers, const std::string& url,
+                      const std::string& caBundle) {
+    const CurlApi& curlApi = native_api().curl;
+    curl_engine_set_backend(backend);
+
+    std::vector<void*> handles;
+    handles.reserve((size_t)transfers);
+    for (int i = 0; i < transfers; ++i) {
+        void* curl = curlApi.easy_init();
+        if (!curl) {
+            fprintf(stderr, "curl_easy_init failed after %d handles\n", i);
+            _exit(2);
+        }
+        curlApi.easy_setopt(curl, CURLOPT_URL, url.c_str());
+        curlApi.easy_setopt(curl, CURLOPT_WRITEFUNCTION, discard);
+        curlApi.easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+        curlApi.easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, 30000L);
+        if (!caBundle.empty()) curlApi.easy_setopt(curl, CURLOPT_CAINFO, caBundle.c_str());
+        handles.push_back(curl);
+    }
+
+    std::mutex mu;
+    std::condition_variable cv;
+    int done = 0, failed = 0, firstError = 0;
+    double cpuBegin = cpu_ms();
+    auto begin = Clock::now();
+    for (void* curl : handles) {
+        EngineJob job;
+        job.curl = curl;
+        job.done = [&](uint64_t, int rc, const std::string&) {
+            std::lock_guard<std::mutex> lock(mu);
+            if (rc != CURLE_OK) {
+                if (!failed) firstError = rc;
+                failed++;
+            }
+            if (++done == transfers) cv.notify_one();
+        };
+        if (curl_engine_submit(std::move(job)) == 0) {
+            fprintf(stderr, "curl_engine_submit refused the job\n");
+            _exit(2);
+        }
+    }
+    {
+        std::unique_lock<std::mutex> lock(mu);
+        cv.wait(lock, [&] { return done == transfers; });
+    }
+    double wallMs = std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+    double cpu = cpu_ms() - cpuBegin;
+    EngineStats st = curl_engine_stats();
+
+    printf("%-6s %6d %6d %6d %10.0f %10.0f %12.1f %6llu\n", name, transfers, transfers - failed, failed, wallMs, cpu,
+           cpu * 1000.0 / transfers, (unsigned long long)st.peakInFlight);
+    if (failed) fprintf(stderr, "%s/%d: first error rc=%d\n", name, transfers, firstError);
+    fflush(stdout);
+    // the engine thread never exits; leave without tearing the multi down under it
+    _exit(failed ? 1 : 0);
+}
+
+void usage(const char* argv0) {
+    fprintf(stderr, "usage: %s [-b poll|epoll|both] [-n N[,N...]] [-c CA_BUNDLE] URL\n", argv0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string backends = "both";
+    std::string counts = "1000,3000";
+    std::string caBundle;
+    int argi = 1;
+    for (; argi + 1 < argc && argv[argi][0] == '-'; argi += 2) {
+        if (!strcmp(argv[argi], "-b")) backends = argv[argi + 1];
+        else if (!strcmp(argv[argi], "-n")) counts = argv[argi + 1];
+        else if (!strcmp(argv[argi], "-c")) caBundle = argv[argi + 1];
+        else break;
+    }
+    if (argc - argi != 1) {
+        usage(argv[0]);
+        return 2;
+    }
+    std::string url = argv[argi];
+
+    struct Backend {
+        EngineBackend backend;
+        const char* name;
+    };
+    std::vector<Backend> selected;
+    if (backends == "poll" || backends == "both") selected.push_back({EngineBackend::Poll, "poll"});
+    if (backends == "epoll" || backends == "both") selected.push_back({EngineBackend::Epoll, "epoll"});
+    std::vector<int> ns;
+    for (const char* p = counts.c_str(); *p;) {
+        char* end = nullptr;
+        long n = strtol(p, &end, 10);
+        if (end == p || n <= 0) break;
+        ns.push_back((int)n);
+        p = *end == ',' ? end + 1 : end;
+    }
+    if (selected.empty() || ns.empty()) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    const NativeApi& api = native_api();
+    if (!api.has(NATIVE_CAP_CURL | NATIVE_CAP_MULTI)) {
+        fprintf(stderr, "libcurl lacks the curl_multi symbols (caps=0x%x)\n", api.caps);
+        return 2;
+    }
+    rlimit nofile{};
+    getrlimit(RLIMIT_NOFILE, &nofile);
+    nofile.rlim_cur = nofile.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &nofile);
+
+    printf("%-6s %6s %6s %6s %10s %10s %12s %6s\n", "engine", "N", "ok", "failed", "wall ms", "cpu ms",
+           "cpu us/xfer", "peak");
+    fflush(stdout);
+    int status = 0;
+    for (const Backend& b : selected) {
+        for (int n : ns) {
+            pid_t pid = fork();
+            if (pid == 0) run(b.backend, b.name, n, url, caBundle);
+            int ws = 0;
+            if (pid < 0 || waitpid(pid, &ws, 0) < 0 || !WIFEXITED(ws) || WEXITSTATUS(ws) != 0) status = 1;
+        }
+    }
+    return status;
+}
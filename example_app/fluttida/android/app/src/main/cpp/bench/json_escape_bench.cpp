@@ -0,0 +1,94 @@
+// JSON escaper microbenchmark: json_escape_append vs the ostringstream loop it replaced.
+//
+// The legacy result encoder pushed the body through std::ostringstream one char at a
+// time. json_escape_append scans clean 16-byte blocks with SSE2/NEON and copies them
+// in bulk into a pre-sized string. Throughput is reported for 1 KB to 10 MB bodies of
+// plain ASCII, mixed UTF-8 text (including emoji) and escape-heavy JSON.
+//
+//   cmake -S . -B build -DCMAKE_BUILD_TYPE=Release -DNATIVEHTTP_BUILD_BENCH=ON
+//   cmake --build build && ./build/json_escape_bench
+
+#include "json_escape.h"
+
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// The removed json_escape_into from native_http.cpp
+void legacy_escape(std::ostringstream& out, const char* p, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        char c = p[i];
+        switch (c) {
+            case '\\': out << "\\\\"; break;
+            case '"': out << "\\\""; break;
+            case '\n': out << "\\n"; break;
+            case '\r': out << "\\r"; break;
+            case '\t': out << "\\t"; break;
+            default: out << c; break;
+        }
+    }
+}
+
+std::string make_body(const char* pattern, size_t size) {
+    std::string body;
+    body.reserve(size + 64);
+    while (body.size() < size) body += pattern;
+    // cut on a sequence boundary so the UTF-8 case stays valid
+    size_t cut = size;
+    while (cut > 0 && ((unsigned char)body[cut] & 0xC0) == 0x80) --cut;
+    body.resize(cut);
+    return body;
+}
+
+// MB/s of fn over body, repeated until at least ~200 ms have been spent
+template <typename Fn>
+double mb_per_s(const std::string& body, Fn&& fn) {
+    size_t iters = 1;
+    for (;;) {
+        auto begin = Clock::now();
+        for (size_t i = 0; i < iters; ++i) fn();
+        double s = std::chrono::duration<double>(Clock::now() - begin).count();
+        if (s >= 0.2) return (double)body.size() * (double)iters / s / 1e6;
+        iters *= 2;
+    }
+}
+
+volatile size_t g_sink;
+
+} // namespace
+
+int main() {
+    struct Kind {
+        const char* name;
+        const char* pattern;
+    } kinds[] = {
+        {"ascii", "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor. "},
+        {"utf8", "Grüße aus Köln, 東京からこんにちは, Привет 👋🏽 — ok. "},
+        {"json", "{\"id\":12,\"name\":\"a \\\"quoted\\\" name\",\"path\":\"C:\\\\tmp\",\"note\":\"line\\nbreak\"},\n"},
+    };
+    const size_t sizes[] = {1024, 64 * 1024, 1024 * 1024, 10 * 1024 * 1024};
+
+    printf("%-6s  %10s  %14s  %14s  %8s\n", "body", "bytes", "legacy MB/s", "escape MB/s", "speedup");
+    for (const Kind& k : kinds) {
+        for (size_t size : sizes) {
+            std::string body = make_body(k.pattern, size);
+            double legacy = mb_per_s(body, [&] {
+                std::ostringstream out;
+                legacy_escape(out, body.data(), body.size());
+                g_sink = out.str().size();
+            });
+            double fast = mb_per_s(body, [&] {
+                std::string out;
+                json_escape_append(out, body.data(), body.size());
+                g_sink = out.size();
+            });
+            printf("%-6s  %10zu  %14.0f  %14.0f  %7.1fx\n", k.name, body.size(), legacy, fast, fast / legacy);
+        }
+    }
+    return 0;
+}
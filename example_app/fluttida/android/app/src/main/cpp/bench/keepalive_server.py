@@ -0,0 +1,47 @@
+# Keep-alive HTTP(S) server for the host benchmarks.
+#
+#   python3 keepalive_server.py PORT [CERT KEY]
+#
+# Serves "ok" over HTTP/1.1 with keep-alive, over TLS when a certificate is given.
+# GET /delay/<ms> holds the response for <ms> milliseconds, /delay/<lo>-<hi> for a
+# random time in that range; this keeps thousands of transfers in flight at once for
+# engine_bench, completing one by one. One asyncio loop serves every connection, so
+# the server stays cheap next to the client being measured.
+import asyncio
+import random
+import resource
+import ssl
+import sys
+
+
+async def serve(reader, writer):
+    try:
+        while True:
+            request = await reader.readuntil(b"\r\n\r\n")
+            path = request.split(b" ", 2)[1]
+            if path.startswith(b"/delay/"):
+                lo, _, hi = path[7:].partition(b"-")
+                ms = random.randint(int(lo), int(hi)) if hi else int(lo)
+                await asyncio.sleep(ms / 1000.0)
+            writer.write(b"HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok")
+            await writer.drain()
+    except (asyncio.IncompleteReadError, ConnectionError, IndexError, ValueError):
+        pass
+    finally:
+        writer.close()
+
+
+async def main():
+    context = None
+    if len(sys.argv) > 3:
+        context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+        context.load_cert_chain(sys.argv[2], sys.argv[3])
+    # asyncio enables TCP_NODELAY on every accepted socket
+    server = await asyncio.start_server(serve, "localhost", int(sys.argv[1]), ssl=context, backlog=4096)
+    async with server:
+        await server.serve_forever()
+
+
+soft, hard = resource.getrlimit(resource.RLIMIT_NOFILE)
+resource.setrlimit(resource.RLIMIT_NOFILE, (hard, hard))
+asyncio.run(main())
@@ -0,0 +1,104 @@
+// Pin matching microbenchmark: compiled PinSet vs the per-handshake CSV scan it replaced.
+//
+// The old verify path base64-encoded the leaf digest, split the pin CSV with an
+// istringstream, stripped "sha256/", trimmed and string-compared every token on each
+// handshake. PinSet::compile does that parsing once; a handshake then binary-searches
+// raw 32-byte digests. Timed per lookup for 1, 10 and 1,000 pins, for a digest that
+// matches the last pin and for one that matches none (both full scans for the CSV).
+//
+//   cmake -S . -B build -DCMAKE_BUILD_TYPE=Release -DNATIVEHTTP_BUILD_BENCH=ON
+//   cmake --build build && ./build/pin_match_bench
+
+#include "pin_matcher.h"
+
+#include <array>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::string base64_32(const unsigned char* d) {
+    static const char kTable[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    unsigned v = 0;
+    int bits = -6;
+    for (int i = 0; i < 32; ++i) {
+        v = (v << 8) + d[i];
+        bits += 8;
+        while (bits >= 0) {
+            out += kTable[(v >> bits) & 63];
+            bits -= 6;
+        }
+    }
+    if (bits > -6) out += kTable[((v << 8) >> (bits + 8)) & 63];
+    while (out.size() % 4) out += '=';
+    return out;
+}
+
+// The removed leaf_matches_pins comparison, minus its logging
+bool csv_matches(const std::string& csv, const unsigned char digest[32]) {
+    std::string b64 = base64_32(digest);
+    std::istringstream iss(csv);
+    std::string tok;
+    while (std::getline(iss, tok, ',')) {
+        size_t p = tok.find("sha256/");
+        std::string np = (p == std::string::npos) ? tok : tok.substr(p + 7);
+        while (!np.empty() && isspace((unsigned char)np.front())) np.erase(np.begin());
+        while (!np.empty() && isspace((unsigned char)np.back())) np.pop_back();
+        if (np == b64) return true;
+    }
+    return false;
+}
+
+// Nanoseconds per call of fn, repeated until at least ~200 ms have been spent
+template <typename Fn>
+double ns_per_op(Fn&& fn) {
+    size_t iters = 1;
+    for (;;) {
+        auto begin = Clock::now();
+        for (size_t i = 0; i < iters; ++i) fn();
+        double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - begin).count();
+        if (ns >= 2e8) return ns / (double)iters;
+        iters *= 2;
+    }
+}
+
+volatile int g_sink;
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(42);
+    printf("%6s  %-8s  %14s  %14s  %14s\n", "pins", "leaf", "csv scan ns", "PinSet ns", "compile us");
+    for (size_t count : {(size_t)1, (size_t)10, (size_t)1000}) {
+        std::vector<std::array<unsigned char, 32>> digests(count);
+        std::string csv;
+        for (size_t i = 0; i < count; ++i) {
+            for (unsigned char& b : digests[i]) b = (unsigned char)rng();
+            if (i > 0) csv += ", ";
+            csv += "sha256/" + base64_32(digests[i].data());
+        }
+        std::array<unsigned char, 32> absent;
+        for (unsigned char& b : absent) b = (unsigned char)rng();
+
+        double compileNs = ns_per_op([&] { g_sink = (int)PinSet::compile(csv).size(); });
+        PinSet set = PinSet::compile(csv);
+        struct Case {
+            const char* name;
+            const unsigned char* digest;
+        } cases[] = {{"last", digests.back().data()}, {"none", absent.data()}};
+        for (const Case& c : cases) {
+            double csvNs = ns_per_op([&] { g_sink = csv_matches(csv, c.digest); });
+            double setNs = ns_per_op([&] { g_sink = set.contains(c.digest); });
+            printf("%6zu  %-8s  %14.1f  %14.1f  %14.2f\n", count, c.name, csvNs, setNs, compileNs / 1000.0);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,248 @@
+// Connection cost of the native curl pinning techniques against a local TLS server.
+//
+// For each technique the same N requests are made twice:
+//  - cold: every request opens a new connection (FRESH_CONNECT, FORBID_REUSE) with a
+//          full TLS handshake (no session-ID cache);
+//  - warm: one handle keeps its connection alive across requests.
+// Connections are counted as curl's CURLINFO_NUM_CONNECTS plus the preflight's own TCP
+// connect, i.e. TCP + TLS handshakes per request.
+//  - unpinned:  no pin check;
+//  - handshake: pin_verify_peer on curl's own connection before any request bytes;
+//  - preflight: a separate DNS-cached, happy-eyeballs TCP connect and TLS handshake
+//               on the shared preflight context (as run_preflight does), then curl.
+// The pins are learned from the server first, so every pinned request passes.
+//
+// The server must keep connections alive (openssl s_server -www closes after each
+// response, which makes every warm request cold); keepalive_server.py next to this
+// file serves HTTP/1.1 with keep-alive:
+//   openssl req -x509 -newkey rsa:2048 -nodes -subj /CN=localhost -keyout k.pem -out c.pem
+//   python3 bench/keepalive_server.py 44310 c.pem k.pem &
+//   cmake -S . -B build -DCMAKE_BUILD_TYPE=Release -DNATIVEHTTP_BUILD_BENCH=ON
+//   cmake --build build && ./build/pin_roundtrip_bench c.pem 44310 200
+
+#include "curl_share.h"
+#include "dns_cache.h"
+#include "happy_eyeballs.h"
+#include "native_api.h"
+#include "pin_matcher.h"
+#include "pin_verify.h"
+#include "preflight_ctx.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include <curl/curl.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+enum class Technique { Unpinned, Handshake, Preflight };
+
+const char* technique_name(Technique t) {
+    switch (t) {
+        case Technique::Unpinned: return "unpinned";
+        case Technique::Handshake: return "handshake";
+        case Technique::Preflight: return "preflight";
+    }
+    return "?";
+}
+
+struct Run {
+    long curlConnects = 0;
+    long preflightConnects = 0;
+    long checks = 0;        // pin checks that ran (handshake: also on reused connections)
+    long failures = 0;
+    long resumed = 0;       // TLS handshakes that resumed (curl's or the preflight's)
+    double ms = 0;
+};
+
+std::shared_ptr<const PinMatcher> g_pins;
+std::atomic<long> g_checks{0};
+
+std::string base64_32(const unsigned char* d) {
+    static const char kTable[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    unsigned v = 0;
+    int bits = -6;
+    for (int i = 0; i < 32; ++i) {
+        v = (v << 8) + d[i];
+        bits += 8;
+        while (bits >= 0) {
+            out += kTable[(v >> bits) & 63];
+            bits -= 6;
+        }
+    }
+    if (bits > -6) out += kTable[((v << 8) >> (bits + 8)) & 63];
+    while (out.size() % 4) out += '=';
+    return out;
+}
+
+// ShareProbe::tlsCheck for the learning request: the leaf's certificate pin
+bool learn_pin(void* ssl, void* data) {
+    const NativeApi& api = native_api();
+    void* peer = ssl ? api.ssl.SSL_get_peer_certificate(ssl) : nullptr;
+    if (!peer) return false;
+    unsigned char* der = nullptr;
+    int len = api.crypto.i2d_X509(peer, &der);
+    api.crypto.X509_free(peer);
+    if (len <= 0 || !der) return false;
+    unsigned char d[32];
+    api.crypto.SHA256(der, (size_t)len, d);
+    free(der);
+    *(std::string*)data = "sha256/" + base64_32(d);
+    return true;
+}
+
+// ShareProbe::tlsCheck for the handshake technique (native_http's handshake_pin_check)
+bool handshake_check(void* ssl, void*) {
+    g_checks++;
+    return pin_verify_peer(ssl, *g_pins, "Handshake");
+}
+
+// The native branch of run_preflight: cached DNS, raced connect, TLS on the shared
+// context, pin check, session kept for the next preflight
+bool preflight(const std::string& caBundle, int port, Run& run) {
+    std::vector<DnsAddress> addrs;
+    if (!dns_resolve("localhost", port, &addrs)) return false;
+    ConnectResult cr = happy_eyeballs_connect(addrs, 5000);
+    if (cr.fd < 0) return false;
+    run.preflightConnects++;
+    PreflightTls tls;
+    if (!preflight_tls_begin(tls, caBundle, false, "localhost", port, cr.fd)) {
+        close(cr.fd);
+        return false;
+    }
+    bool ok = preflight_tls_connect(tls);
+    if (ok) {
+        g_checks++;
+        ok = pin_verify_peer(tls.ssl, *g_pins, "Preflight");
+        if (tls.resumed) run.resumed++;
+    }
+    preflight_tls_end(tls, ok);
+    return ok;
+}
+
+size_t discard(char*, size_t size, size_t nmemb, void*) {
+    return size * nmemb;
+}
+
+// Configures a handle for url; probe must outlive the handle's transfers
+void* new_handle(const std::string& url, const std::string& caBundle, Technique t, bool cold, ShareProbe* probe) {
+    const CurlApi& curlApi = native_api().curl;
+    void* curl = curlApi.easy_init();
+    if (!curl) return nullptr;
+    curlApi.easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curlApi.easy_setopt(curl, CURLOPT_CAINFO, caBundle.c_str());
+    curlApi.easy_setopt(curl, CURLOPT_WRITEFUNCTION, discard);
+    curlApi.easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    if (cold) {
+        curlApi.easy_setopt(curl, CURLOPT_FRESH_CONNECT, 1L);
+        curlApi.easy_setopt(curl, CURLOPT_FORBID_REUSE, 1L);
+        curlApi.easy_setopt(curl, CURLOPT_SSL_SESSIONID_CACHE, 0L);
+    }
+    if (t == Technique::Handshake) probe->tlsCheck = handshake_check;
+    // pinned handles get their own share, as native_http isolates them per pin configuration
+    if (!curl_share_attach(curl, probe, std::string(technique_name(t)) + (cold ? "|cold" : "|warm"))) {
+        curlApi.easy_cleanup(curl);
+        return nullptr;
+    }
+    return curl;
+}
+
+Run run(const std::string& caBundle, int port, Technique t, bool cold, int requests) {
+    const CurlApi& curlApi = native_api().curl;
+    std::string url = "https://localhost:" + std::to_string(port) + "/";
+    Run r;
+    g_checks = 0;
+    ShareProbe probe;
+    void* warm = nullptr;
+    auto begin = Clock::now();
+    for (int i = 0; i < requests; ++i) {
+        if (t == Technique::Preflight && !preflight(caBundle, port, r)) {
+            r.failures++;
+            continue;
+        }
+        void* curl = warm;
+        if (!curl) curl = new_handle(url, caBundle, t, cold, &probe);
+        if (!curl) {
+            r.failures++;
+            continue;
+        }
+        probe.tlsResumed = -1;
+        int rc = curlApi.easy_perform(curl);
+        long connects = 0;
+        curlApi.easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &connects);
+        r.curlConnects += connects;
+        if (connects > 0 && probe.tlsResumed == 1) r.resumed++;
+        if (rc != CURLE_OK) r.failures++;
+        if (cold) curlApi.easy_cleanup(curl);
+        else warm = curl;
+    }
+    if (warm) curlApi.easy_cleanup(warm);
+    r.ms = std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+    r.checks = g_checks.load();
+    return r;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s CA_BUNDLE PORT [REQUESTS]\n", argv[0]);
+        return 2;
+    }
+    std::string caBundle = argv[1];
+    int port = atoi(argv[2]);
+    int requests = argc > 3 ? atoi(argv[3]) : 200;
+    if (requests <= 0) requests = 200;
+
+    const NativeApi& api = native_api();
+    if (!api.has(NATIVE_CAP_CURL | NATIVE_CAP_SHARE | NATIVE_CAP_PEER_PIN | NATIVE_CAP_PREFLIGHT)) {
+        fprintf(stderr, "libcurl/OpenSSL lacks the pinning symbols (caps=0x%x)\n", api.caps);
+        return 2;
+    }
+
+    // Learn the server's certificate pin through the handshake probe
+    std::string pin;
+    {
+        const CurlApi& curlApi = api.curl;
+        std::string url = "https://localhost:" + std::to_string(port) + "/";
+        ShareProbe probe;
+        probe.tlsCheck = learn_pin;
+        probe.tlsCheckData = &pin;
+        void* curl = curlApi.easy_init();
+        curlApi.easy_setopt(curl, CURLOPT_URL, url.c_str());
+        curlApi.easy_setopt(curl, CURLOPT_CAINFO, caBundle.c_str());
+        curlApi.easy_setopt(curl, CURLOPT_WRITEFUNCTION, discard);
+        int rc = curl_share_attach(curl, &probe, "learn") ? curlApi.easy_perform(curl) : CURLE_FAILED_INIT;
+        curlApi.easy_cleanup(curl);
+        if (rc != CURLE_OK || pin.empty()) {
+            fprintf(stderr, "learning request to port %d failed (rc=%d)\n", port, rc);
+            return 2;
+        }
+    }
+    g_pins = pin_matcher_compile(pin, std::string());
+
+    printf("%d requests per run against localhost:%d\n", requests, port);
+    printf("%-10s %-5s %10s %12s %10s %10s %8s %8s\n", "technique", "run", "curl/rq", "preflight/rq", "total/rq",
+           "checks/rq", "resumed", "ms/rq");
+    int failures = 0;
+    for (bool cold : {true, false}) {
+        for (Technique t : {Technique::Unpinned, Technique::Handshake, Technique::Preflight}) {
+            Run r = run(caBundle, port, t, cold, requests);
+            double n = (double)requests;
+            printf("%-10s %-5s %10.2f %12.2f %10.2f %10.2f %8ld %8.2f\n", technique_name(t), cold ? "cold" : "warm",
+                   r.curlConnects / n, r.preflightConnects / n, (r.curlConnects + r.preflightConnects) / n,
+                   r.checks / n, r.resumed, r.ms / n);
+            failures += (int)r.failures;
+        }
+    }
+    if (failures) fprintf(stderr, "%d requests failed\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,77 @@
+#include "body_buffer.h"
+#include "native_api.h"
+#include "native_log.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#include <curl/curl.h>
+
+// Larger Content-Length values are not trusted for the up-front allocation
+static constexpr int64_t kMaxPresize = 64LL * 1024 * 1024;
+
+static void put_i32(uint8_t* p, int32_t v) {
+    uint32_t u = (uint32_t)v;
+    p[0] = (uint8_t)u;
+    p[1] = (uint8_t)(u >> 8);
+    p[2] = (uint8_t)(u >> 16);
+    p[3] = (uint8_t)(u >> 24);
+}
+
+BodyBuffer::~BodyBuffer() {
+    free(data_);
+}
+
+bool BodyBuffer::reserve(size_t bodyCapacity) {
+    if (bodyCapacity <= cap_ && data_) return true;
+    auto* grown = (uint8_t*)realloc(data_, kBodyHeaderSize + bodyCapacity);
+    if (!grown) return false;
+    data_ = grown;
+    cap_ = bodyCapacity;
+    return true;
+}
+
+size_t BodyBuffer::write(void* ptr, size_t size, size_t nmemb, void* userdata) {
+    auto* b = (BodyBuffer*)userdata;
+    size_t total = size * nmemb;
+    if (!b || b->failed_) return 0; // short write aborts the transfer with CURLE_WRITE_ERROR
+
+    if (!b->presized_) {
+        b->presized_ = true;
+        curl_off_t contentLength = -1;
+        if (b->curl_) native_api().curl.easy_getinfo(b->curl_, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &contentLength);
+        if (contentLength > 0 && contentLength <= kMaxPresize) b->reserve((size_t)contentLength);
+    }
+    if (b->len_ + total > b->cap_) {
+        size_t want = b->cap_ ? b->cap_ * 2 : 16 * 1024;
+        while (want < b->len_ + total) want *= 2;
+        if (!b->reserve(want)) {
+            LOGE("BodyBuffer: out of memory at %zu bytes", b->len_ + total);
+            b->failed_ = true;
+            return 0;
+        }
+    }
+    memcpy(b->data_ + kBodyHeaderSize + b->len_, ptr, total);
+    b->len_ += total;
+    return total;
+}
+
+uint8_t* BodyBuffer::seal(int status, int durationMs, int errorCode, const char* error,
+                          const char* httpVersion, size_t* totalLen) {
+    size_t errLen = error ? strlen(error) : 0;
+    if (!reserve(len_ + errLen)) return nullptr;
+    uint8_t* out = data_;
+    put_i32(out + 0, status);
+    put_i32(out + 4, durationMs);
+    put_i32(out + 8, errorCode);
+    put_i32(out + 12, (int32_t)len_);
+    put_i32(out + 16, (int32_t)errLen);
+    memset(out + 20, 0, 4);
+    if (httpVersion) memcpy(out + 20, httpVersion, strnlen(httpVersion, 4));
+    if (errLen) memcpy(out + kBodyHeaderSize + len_, error, errLen);
+    *totalLen = kBodyHeaderSize + len_ + errLen;
+
+    data_ = nullptr;
+    len_ = cap_ = 0;
+    return out;
+}
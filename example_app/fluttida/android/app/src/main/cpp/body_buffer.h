@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Response body written straight into one malloc'ed block that is later handed to
+// Java as a direct ByteBuffer (NewDirectByteBuffer) and on to Dart as a Uint8List
+// view, so a download is never copied into std::string / jstring / JSON.
+//
+// Block layout (little-endian), shared with NativeHttp.kt and stacks_impl.dart:
+//   0  int32  status        HTTP status, -1 when there is no response
+//   4  int32  durationMs
+//   8  int32  errorCode     CURLcode, or -1 for setup/pinning failures
+//   12 int32  bodyLength
+//   16 int32  errorLength   UTF-8 error text stored right after the body
+//   20 char[4] httpVersion  "1.1", "2", ... NUL padded
+//   24 body bytes, then error bytes
+constexpr size_t kBodyHeaderSize = 24;
+
+class BodyBuffer {
+public:
+    BodyBuffer() = default;
+    ~BodyBuffer();
+    BodyBuffer(const BodyBuffer&) = delete;
+    BodyBuffer& operator=(const BodyBuffer&) = delete;
+
+    // Handle used to presize from Content-Length on the first write
+    void setCurl(void* curl) { curl_ = curl; }
+
+    // CURLOPT_WRITEFUNCTION; userdata is the BodyBuffer
+    static size_t write(void* ptr, size_t size, size_t nmemb, void* userdata);
+
+    // Fills the header, appends the error text and gives up ownership of the block
+    // (release with free()). Returns nullptr on allocation failure.
+    uint8_t* seal(int status, int durationMs, int errorCode, const char* error,
+                  const char* httpVersion, size_t* totalLen);
+
+private:
+    bool reserve(size_t bodyCapacity);
+
+    uint8_t* data_ = nullptr;   // header + body (+ error after seal)
+    size_t len_ = 0;            // body bytes written
+    size_t cap_ = 0;            // body capacity
+    void* curl_ = nullptr;
+    bool presized_ = false;
+    bool failed_ = false;
+};
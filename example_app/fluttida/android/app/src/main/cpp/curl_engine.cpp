@@ -0,0 +1,425 @@
+#include "curl_engine.h"
+#include "native_api.h"
+#include "native_log.h"
+
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <curl/curl.h>
+
+// Blocking prepare steps (preflight handshakes, DNS misses) run on this many helper threads at most
+static constexpr int kMaxPrepareThreads = 4;
+
+struct PendingJob {
+    uint64_t id;
+    EngineJob job;
+};
+
+class CurlEngine {
+public:
+    explicit CurlEngine(EngineBackend backend) : backend_(backend) {}
+    bool start();
+    uint64_t submit(EngineJob job);
+    void post(std::function<void()> task);
+    EngineStats stats();
+    void wake();    // nudges the loop thread (new jobs or config)
+
+private:
+    bool startEpoll();
+    void pollLoop();
+    void epollLoop();
+    void prepareLoop();
+    void enqueue(PendingJob pj);
+    void applyConfig();
+    void addIncoming();
+    void runPosted();
+    void drainDone();
+    void finish(PendingJob& pj, int rc, const std::string& err);
+
+    // curl_multi callbacks for the epoll backend
+    static int onSocket(void* easy, curl_socket_t s, int what, void* userp, void* socketp);
+    static int onTimer(void* multi, long timeoutMs, void* userp);
+
+    EngineBackend backend_;
+    void* multi_ = nullptr;
+    std::atomic<uint64_t> nextId_{1};
+
+    int epfd_ = -1;     // epoll backend: curl sockets + timerfd + eventfd
+    int timerfd_ = -1;  // armed from CURLMOPT_TIMERFUNCTION
+    int wakefd_ = -1;   // eventfd written by wake()
+
+    std::mutex queueMutex_;
+    std::deque<PendingJob> incoming_;       // ready to be added to the multi
+    std::deque<PendingJob> batch_;          // loop thread only
+    std::deque<std::function<void()>> posted_;      // guarded by queueMutex_
+    std::deque<std::function<void()>> postedBatch_; // loop thread only
+    long maxStreams_ = 0;                   // loop thread only; last applied CURLMOPT_MAX_CONCURRENT_STREAMS
+
+    std::mutex prepMutex_;
+    std::condition_variable prepCv_;
+    std::deque<PendingJob> preparing_;      // waiting for the blocking prepare step
+    int prepThreads_ = 0;                   // prepare workers started (at most kMaxPrepareThreads)
+    int prepIdle_ = 0;                      // ... currently waiting for a job
+
+    std::unordered_map<void*, PendingJob> active_; // loop thread only
+
+    std::atomic<uint64_t> submitted_{0};
+    std::atomic<uint64_t> completed_{0};
+    std::atomic<uint64_t> inFlight_{0};
+    std::atomic<uint64_t> peakInFlight_{0};
+};
+
+// Marker stored with curl_multi_assign once a socket is registered with epoll
+static char g_socketRegistered;
+
+static std::atomic<long> g_maxStreams{0};
+
+bool CurlEngine::start() {
+    const NativeApi& api = native_api();
+    if (!api.has(NATIVE_CAP_MULTI)) {
+        LOGE("curl_engine: curl_multi API unavailable");
+        return false;
+    }
+    if (backend_ == EngineBackend::Auto) {
+        backend_ = api.has(NATIVE_CAP_MULTI_SOCKET) ? EngineBackend::Epoll : EngineBackend::Poll;
+    } else if (backend_ == EngineBackend::Epoll && !api.has(NATIVE_CAP_MULTI_SOCKET)) {
+        LOGE("curl_engine: curl_multi_socket_action unavailable, falling back to poll");
+        backend_ = EngineBackend::Poll;
+    }
+    multi_ = api.curl.multi_init();
+    if (!multi_) {
+        LOGE("curl_engine: curl_multi_init failed");
+        return false;
+    }
+    // Multiplex HTTP/2 requests to the same origin over one connection (libcurl's default
+    // since 7.62, set explicitly so older builds behave the same)
+    api.curl.multi_setopt(multi_, CURLMOPT_PIPELINING, (long)CURLPIPE_MULTIPLEX);
+    if (backend_ == EngineBackend::Epoll && !startEpoll()) {
+        LOGE("curl_engine: epoll setup failed (errno=%d), falling back to poll", errno);
+        backend_ = EngineBackend::Poll;
+    }
+    if (backend_ == EngineBackend::Epoll) {
+        std::thread(&CurlEngine::epollLoop, this).detach();
+    } else {
+        std::thread(&CurlEngine::pollLoop, this).detach();
+    }
+    LOGI("curl_engine: event loop started (%s)", backend_ == EngineBackend::Epoll ? "epoll" : "poll");
+    return true;
+}
+
+bool CurlEngine::startEpoll() {
+    epfd_ = epoll_create1(EPOLL_CLOEXEC);
+    timerfd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    wakefd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    bool ok = epfd_ >= 0 && timerfd_ >= 0 && wakefd_ >= 0;
+    if (ok) {
+        struct epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = timerfd_;
+        ok = epoll_ctl(epfd_, EPOLL_CTL_ADD, timerfd_, &ev) == 0;
+        ev.data.fd = wakefd_;
+        ok = ok && epoll_ctl(epfd_, EPOLL_CTL_ADD, wakefd_, &ev) == 0;
+    }
+    if (!ok) {
+        if (epfd_ >= 0) close(epfd_);
+        if (timerfd_ >= 0) close(timerfd_);
+        if (wakefd_ >= 0) close(wakefd_);
+        epfd_ = timerfd_ = wakefd_ = -1;
+        return false;
+    }
+    const CurlApi& curlApi = native_api().curl;
+    curlApi.multi_setopt(multi_, CURLMOPT_SOCKETFUNCTION, &CurlEngine::onSocket);
+    curlApi.multi_setopt(multi_, CURLMOPT_SOCKETDATA, this);
+    curlApi.multi_setopt(multi_, CURLMOPT_TIMERFUNCTION, &CurlEngine::onTimer);
+    curlApi.multi_setopt(multi_, CURLMOPT_TIMERDATA, this);
+    return true;
+}
+
+uint64_t CurlEngine::submit(EngineJob job) {
+    PendingJob pj{nextId_.fetch_add(1), std::move(job)};
+    uint64_t id = pj.id;
+    submitted_.fetch_add(1, std::memory_order_relaxed);
+    uint64_t now = inFlight_.fetch_add(1, std::memory_order_relaxed) + 1;
+    uint64_t peak = peakInFlight_.load(std::memory_order_relaxed);
+    while (now > peak && !peakInFlight_.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {}
+
+    if (pj.job.prepare) {
+        std::lock_guard<std::mutex> lock(prepMutex_);
+        // grow the pool only while every worker is busy, so one slow preflight
+        // doesn't hold up the jobs queued behind it
+        if (prepIdle_ == 0 && prepThreads_ < kMaxPrepareThreads) {
+            std::thread(&CurlEngine::prepareLoop, this).detach();
+            ++prepThreads_;
+        }
+        preparing_.push_back(std::move(pj));
+        prepCv_.notify_one();
+    } else {
+        enqueue(std::move(pj));
+    }
+    return id;
+}
+
+void CurlEngine::enqueue(PendingJob pj) {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        incoming_.push_back(std::move(pj));
+    }
+    wake();
+}
+
+void CurlEngine::post(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        posted_.push_back(std::move(task));
+    }
+    wake();
+}
+
+void CurlEngine::wake() {
+    if (backend_ == EngineBackend::Epoll) {
+        uint64_t one = 1;
+        ssize_t n = write(wakefd_, &one, sizeof(one));
+        (void)n; // EAGAIN means the counter is already non-zero, i.e. a wakeup is pending
+    } else {
+        native_api().curl.multi_wakeup(multi_);
+    }
+}
+
+void CurlEngine::finish(PendingJob& pj, int rc, const std::string& err) {
+    inFlight_.fetch_sub(1, std::memory_order_relaxed);
+    completed_.fetch_add(1, std::memory_order_relaxed);
+    if (pj.job.done) pj.job.done(pj.id, rc, err);
+}
+
+void CurlEngine::prepareLoop() {
+    for (;;) {
+        PendingJob pj;
+        {
+            std::unique_lock<std::mutex> lock(prepMutex_);
+            ++prepIdle_;
+            prepCv_.wait(lock, [this] { return !preparing_.empty(); });
+            --prepIdle_;
+            pj = std::move(preparing_.front());
+            preparing_.pop_front();
+        }
+        std::string err;
+        if (pj.job.prepare(err)) {
+            enqueue(std::move(pj));
+        } else {
+            finish(pj, -1, err);
+        }
+    }
+}
+
+void CurlEngine::applyConfig() {
+    long want = g_maxStreams.load(std::memory_order_relaxed);
+    if (want == maxStreams_) return;
+    // curl_multi_setopt isn't thread-safe, hence applied here on the loop thread
+    int mrc = native_api().curl.multi_setopt(multi_, CURLMOPT_MAX_CONCURRENT_STREAMS, want > 0 ? want : 100L);
+    if (mrc != CURLM_OK) LOGE("curl_engine: CURLMOPT_MAX_CONCURRENT_STREAMS rc=%d", mrc);
+    maxStreams_ = want;
+}
+
+void CurlEngine::addIncoming() {
+    const CurlApi& curlApi = native_api().curl;
+    applyConfig();
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        batch_.swap(incoming_);
+    }
+    for (auto& pj : batch_) {
+        void* curl = pj.job.curl;
+        // With the epoll backend this fires onTimer(0), which kicks the transfer off
+        int mrc = curlApi.multi_add_handle(multi_, curl);
+        if (mrc != CURLM_OK) {
+            LOGE("curl_engine: curl_multi_add_handle failed rc=%d", mrc);
+            finish(pj, CURLE_FAILED_INIT, std::string());
+            continue;
+        }
+        active_.emplace(curl, std::move(pj));
+    }
+    batch_.clear();
+}
+
+void CurlEngine::runPosted() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        postedBatch_.swap(posted_);
+    }
+    for (auto& task : postedBatch_) task();
+    postedBatch_.clear();
+}
+
+void CurlEngine::drainDone() {
+    const CurlApi& curlApi = native_api().curl;
+    int queued = 0;
+    while (CURLMsg* msg = (CURLMsg*)curlApi.multi_info_read(multi_, &queued)) {
+        if (msg->msg != CURLMSG_DONE) continue;
+        void* curl = msg->easy_handle;
+        int rc = msg->data.result;
+        curlApi.multi_remove_handle(multi_, curl);
+        auto it = active_.find(curl);
+        if (it == active_.end()) continue;
+        PendingJob pj = std::move(it->second);
+        active_.erase(it);
+        finish(pj, rc, std::string());
+    }
+}
+
+void CurlEngine::pollLoop() {
+    const CurlApi& curlApi = native_api().curl;
+    for (;;) {
+        addIncoming();
+        runPosted();
+        int running = 0;
+        curlApi.multi_perform(multi_, &running);
+        drainDone();
+        // Sleeps until socket activity, a curl timeout, or curl_multi_wakeup from submit()
+        curlApi.multi_poll(multi_, nullptr, 0, 1000, nullptr);
+    }
+}
+
+int CurlEngine::onSocket(void* /*easy*/, curl_socket_t s, int what, void* userp, void* socketp) {
+    auto* self = (CurlEngine*)userp;
+    if (what == CURL_POLL_REMOVE) {
+        // curl may already have closed the fd, in which case the kernel dropped it for us
+        epoll_ctl(self->epfd_, EPOLL_CTL_DEL, s, nullptr);
+        native_api().curl.multi_assign(self->multi_, s, nullptr);
+        return 0;
+    }
+    struct epoll_event ev{};
+    if (what & CURL_POLL_IN) ev.events |= EPOLLIN;
+    if (what & CURL_POLL_OUT) ev.events |= EPOLLOUT;
+    ev.data.fd = s;
+    if (socketp) {
+        if (epoll_ctl(self->epfd_, EPOLL_CTL_MOD, s, &ev) != 0) {
+            LOGE("curl_engine: epoll_ctl MOD fd=%d failed errno=%d", s, errno);
+        }
+    } else if (epoll_ctl(self->epfd_, EPOLL_CTL_ADD, s, &ev) == 0) {
+        native_api().curl.multi_assign(self->multi_, s, &g_socketRegistered);
+    } else {
+        LOGE("curl_engine: epoll_ctl ADD fd=%d failed errno=%d", s, errno);
+    }
+    return 0;
+}
+
+int CurlEngine::onTimer(void* /*multi*/, long timeoutMs, void* userp) {
+    auto* self = (CurlEngine*)userp;
+    struct itimerspec its{};
+    if (timeoutMs > 0) {
+        its.it_value.tv_sec = timeoutMs / 1000;
+        its.it_value.tv_nsec = (timeoutMs % 1000) * 1000000L;
+    } else if (timeoutMs == 0) {
+        // Expire "now": curl must not be re-entered from inside its own callback, and a zero
+        // it_value would disarm the timer, so fire on the next epoll_wait instead
+        its.it_value.tv_nsec = 1;
+    } // -1: all-zero spec disarms the timer
+    timerfd_settime(self->timerfd_, 0, &its, nullptr);
+    return 0;
+}
+
+void CurlEngine::epollLoop() {
+    const CurlApi& curlApi = native_api().curl;
+    constexpr int kMaxEvents = 256;
+    struct epoll_event events[kMaxEvents];
+    for (;;) {
+        int n = epoll_wait(epfd_, events, kMaxEvents, -1);
+        if (n < 0) {
+            if (errno != EINTR) LOGE("curl_engine: epoll_wait failed errno=%d", errno);
+            continue;
+        }
+        int running = 0;
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+            uint64_t count;
+            if (fd == wakefd_) {
+                while (read(wakefd_, &count, sizeof(count)) > 0) {}
+                addIncoming();
+                runPosted();
+            } else if (fd == timerfd_) {
+                while (read(timerfd_, &count, sizeof(count)) > 0) {}
+                curlApi.multi_socket_action(multi_, CURL_SOCKET_TIMEOUT, 0, &running);
+            } else {
+                uint32_t ev = events[i].events;
+                int mask = 0;
+                if (ev & EPOLLIN) mask |= CURL_CSELECT_IN;
+                if (ev & EPOLLOUT) mask |= CURL_CSELECT_OUT;
+                if (ev & (EPOLLERR | EPOLLHUP)) mask |= CURL_CSELECT_ERR;
+                curlApi.multi_socket_action(multi_, fd, mask, &running);
+            }
+        }
+        drainDone();
+    }
+}
+
+EngineStats CurlEngine::stats() {
+    return EngineStats{
+        backend_ == EngineBackend::Epoll ? "epoll" : "poll",
+        submitted_.load(std::memory_order_relaxed),
+        completed_.load(std::memory_order_relaxed),
+        inFlight_.load(std::memory_order_relaxed),
+        peakInFlight_.load(std::memory_order_relaxed),
+        g_maxStreams.load(std::memory_order_relaxed),
+    };
+}
+
+// Leaked on purpose: the loop thread runs for the life of the process
+static std::atomic<CurlEngine*> g_engine{nullptr};
+static std::once_flag g_engineOnce;
+static std::atomic<EngineBackend> g_requestedBackend{EngineBackend::Auto};
+static std::atomic<bool> g_engineStarting{false};
+
+static CurlEngine* engine() {
+    std::call_once(g_engineOnce, [] {
+        g_engineStarting.store(true);
+        auto* eng = new CurlEngine(g_requestedBackend.load());
+        if (eng->start()) g_engine.store(eng);
+        else delete eng;
+    });
+    return g_engine.load();
+}
+
+bool curl_engine_set_backend(EngineBackend backend) {
+    if (g_engineStarting.load()) return false;
+    g_requestedBackend.store(backend);
+    return true;
+}
+
+void curl_engine_set_max_streams(long maxStreams) {
+    g_maxStreams.store(maxStreams);
+    if (CurlEngine* e = g_engine.load()) e->wake();
+}
+
+bool curl_engine_post(std::function<void()> task) {
+    CurlEngine* e = engine();
+    if (!e) return false;
+    e->post(std::move(task));
+    return true;
+}
+
+uint64_t curl_engine_submit(EngineJob job) {
+    CurlEngine* e = engine();
+    return e ? e->submit(std::move(job)) : 0;
+}
+
+EngineStats curl_engine_stats() {
+    // Don't spin up the loop thread just to report zeros
+    CurlEngine* e = g_engine.load();
+    if (!e) {
+        EngineStats st{};
+        st.backend = "none";
+        return st;
+    }
+    return e->stats();
+}
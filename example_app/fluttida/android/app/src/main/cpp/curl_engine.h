@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// Asynchronous transfer engine: one long-lived thread drives a curl_multi
+// handle for every submitted request, so N concurrent requests cost one
+// thread instead of N. Blocking per-request setup (the pinning preflight, a
+// DNS cache miss) runs on a small pool of helper threads before the handle
+// joins the multi; jobs without a prepare step go straight to the loop.
+//
+// Two interchangeable backends drive the multi handle:
+//  - poll:  curl_multi_perform + curl_multi_poll (every wakeup walks all transfers)
+//  - epoll: curl_multi_socket_action driven by epoll + timerfd, so each wakeup
+//           only touches the sockets that are actually ready; this is what
+//           keeps thousands of in-flight transfers cheap.
+//
+// The engine knows nothing about JNI (it builds on plain Linux as well as
+// the NDK); callers get their results through the completion callback,
+// which runs on an engine thread.
+
+struct EngineJob {
+    void* curl = nullptr;   // fully configured easy handle (owned by the caller)
+    // Optional blocking step run before the transfer starts; return false and set err to fail the job
+    std::function<bool(std::string& err)> prepare;
+    // Called once per job: rc is the CURLcode, or -1 with err set when prepare failed
+    std::function<void(uint64_t id, int rc, const std::string& err)> done;
+};
+
+enum class EngineBackend {
+    Auto,   // epoll when curl_multi_socket_action is available, poll otherwise
+    Poll,
+    Epoll,
+};
+
+struct EngineStats {
+    const char* backend;    // "poll", "epoll", or "none" before the engine has started
+    uint64_t submitted;
+    uint64_t completed;
+    uint64_t inFlight;
+    uint64_t peakInFlight;
+    long maxStreams;        // CURLMOPT_MAX_CONCURRENT_STREAMS in effect (0 = libcurl default)
+};
+
+// Selects the backend; only honoured before the first submit. Returns false once the engine runs.
+bool curl_engine_set_backend(EngineBackend backend);
+
+// HTTP/2: caps concurrent streams per multiplexed connection (0 = libcurl default, 100).
+// May be called at any time; the loop thread applies it before adding new transfers.
+void curl_engine_set_max_streams(long maxStreams);
+
+// Runs task on the engine's loop thread (the only thread allowed to touch handles that are
+// in the multi, e.g. for curl_easy_pause). Returns false if the engine is not running.
+bool curl_engine_post(std::function<void()> task);
+
+// Queues a job and returns its request id (> 0), or 0 if curl_multi is unavailable.
+uint64_t curl_engine_submit(EngineJob job);
+
+EngineStats curl_engine_stats();
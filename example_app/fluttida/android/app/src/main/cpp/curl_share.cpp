@@ -0,0 +1,138 @@
+#include "curl_share.h"
+#include "native_api.h"
+#include "native_log.h"
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+#include <curl/curl.h>
+
+// Shares are never cleaned up (easy handles in the pool may still reference them),
+// so the isolated ones are bounded; further pin configurations run unshared
+constexpr size_t kMaxIsolatedShares = 16;
+
+struct ShareLocks {
+    std::mutex locks[CURL_LOCK_DATA_LAST];
+};
+
+static std::atomic<uint64_t> g_lockAcquisitions[CURL_LOCK_DATA_LAST];
+static std::atomic<uint64_t> g_connReused{0};
+static std::atomic<uint64_t> g_connNew{0};
+static std::atomic<uint64_t> g_tlsResumed{0};
+static std::atomic<uint64_t> g_tlsFull{0};
+static std::atomic<uint64_t> g_unshared{0};
+static std::mutex g_isolatedMutex;
+static std::unordered_map<std::string, void*> g_isolated;   // pin configuration -> CURLSH
+
+static void share_lock_cb(void* /*curl*/, int data, int /*access*/, void* userptr) {
+    if (data < 0 || data >= CURL_LOCK_DATA_LAST) return;
+    static_cast<ShareLocks*>(userptr)->locks[data].lock();
+    g_lockAcquisitions[data].fetch_add(1, std::memory_order_relaxed);
+}
+
+static void share_unlock_cb(void* /*curl*/, int data, void* userptr) {
+    if (data < 0 || data >= CURL_LOCK_DATA_LAST) return;
+    static_cast<ShareLocks*>(userptr)->locks[data].unlock();
+}
+
+static void* create_share(const char* label) {
+    const NativeApi& api = native_api();
+    if (!api.has(NATIVE_CAP_SHARE)) return nullptr;
+    const CurlApi& curlApi = api.curl;
+    void* sh = curlApi.share_init();
+    if (!sh) {
+        LOGE("curl_share: curl_share_init failed");
+        return nullptr;
+    }
+    curlApi.share_setopt(sh, CURLSHOPT_LOCKFUNC, share_lock_cb);
+    curlApi.share_setopt(sh, CURLSHOPT_UNLOCKFUNC, share_unlock_cb);
+    curlApi.share_setopt(sh, CURLSHOPT_USERDATA, new ShareLocks());
+    int rc_dns = curlApi.share_setopt(sh, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    int rc_ssl = curlApi.share_setopt(sh, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    int rc_conn = curlApi.share_setopt(sh, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+    LOGI("curl_share: created %s (dns=%d, ssl_session=%d, connect=%d; 0=CURLSHE_OK)", label, rc_dns, rc_ssl, rc_conn);
+    return sh;
+}
+
+void* curl_share() {
+    // Never cleaned up: easy handles in the pool may still reference it at exit
+    static void* sh = create_share("global");
+    return sh;
+}
+
+// Share for one pin configuration; nullptr when unsupported or the bound is reached
+static void* isolated_share(const std::string& key) {
+    std::lock_guard<std::mutex> lock(g_isolatedMutex);
+    auto it = g_isolated.find(key);
+    if (it != g_isolated.end()) return it->second;
+    if (g_isolated.size() >= kMaxIsolatedShares) return nullptr;
+    void* sh = create_share("isolated");
+    if (sh) g_isolated.emplace(key, sh);
+    return sh;
+}
+
+// CURLOPT_PREREQFUNCTION: connection is established (and TLS negotiated), request not yet sent
+static int share_prereq_cb(void* clientp, char* /*primary_ip*/, char* /*local_ip*/,
+                           int /*primary_port*/, int /*local_port*/) {
+    auto* probe = (ShareProbe*)clientp;
+    const NativeApi& api = native_api();
+    if (!probe || !probe->curl) return CURL_PREREQFUNC_OK;
+    void* ssl = nullptr;
+    struct curl_tlssessioninfo* info = nullptr;
+    if (api.curl.easy_getinfo(probe->curl, CURLINFO_TLS_SSL_PTR, &info) == 0 && info &&
+        info->backend == CURLSSLBACKEND_OPENSSL && info->internals) {
+        ssl = info->internals;
+        if (api.ssl.SSL_session_reused) probe->tlsResumed = api.ssl.SSL_session_reused(ssl) ? 1 : 0;
+    }
+    if (probe->tlsCheck && !probe->tlsCheck(ssl, probe->tlsCheckData)) return CURL_PREREQFUNC_ABORT;
+    return CURL_PREREQFUNC_OK;
+}
+
+bool curl_share_attach(void* curl, ShareProbe* probe, const std::string& isolationKey) {
+    const CurlApi& curlApi = native_api().curl;
+    void* sh = isolationKey.empty() ? curl_share() : isolated_share(isolationKey);
+    if (sh) {
+        curlApi.easy_setopt(curl, CURLOPT_SHARE, sh);
+    } else if (!isolationKey.empty()) {
+        // no private cache to keep the pins' connections and sessions apart: use neither
+        curlApi.easy_setopt(curl, CURLOPT_FORBID_REUSE, 1L);
+        curlApi.easy_setopt(curl, CURLOPT_FRESH_CONNECT, 1L);
+        curlApi.easy_setopt(curl, CURLOPT_SSL_SESSIONID_CACHE, 0L);
+        g_unshared.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (!probe) return false;
+    probe->curl = curl;
+    probe->tlsResumed = -1;
+    // CURLOPT_PREREQFUNCTION needs libcurl >= 7.80; older builds reject it
+    if (curlApi.easy_setopt(curl, CURLOPT_PREREQFUNCTION, share_prereq_cb) != 0) return false;
+    curlApi.easy_setopt(curl, CURLOPT_PREREQDATA, probe);
+    return true;
+}
+
+void curl_share_record(void* curl, const ShareProbe* probe) {
+    long connects = 0;
+    if (native_api().curl.easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &connects) != 0) return;
+    if (connects == 0) {
+        g_connReused.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    g_connNew.fetch_add(1, std::memory_order_relaxed);
+    if (probe && probe->tlsResumed == 1) g_tlsResumed.fetch_add(1, std::memory_order_relaxed);
+    else if (probe && probe->tlsResumed == 0) g_tlsFull.fetch_add(1, std::memory_order_relaxed);
+}
+
+ShareStats curl_share_stats() {
+    ShareStats st{};
+    st.dnsLockAcquisitions = g_lockAcquisitions[CURL_LOCK_DATA_DNS].load(std::memory_order_relaxed);
+    st.sslSessionLockAcquisitions = g_lockAcquisitions[CURL_LOCK_DATA_SSL_SESSION].load(std::memory_order_relaxed);
+    st.connectLockAcquisitions = g_lockAcquisitions[CURL_LOCK_DATA_CONNECT].load(std::memory_order_relaxed);
+    st.connReused = g_connReused.load(std::memory_order_relaxed);
+    st.connNew = g_connNew.load(std::memory_order_relaxed);
+    st.tlsResumed = g_tlsResumed.load(std::memory_order_relaxed);
+    st.tlsFull = g_tlsFull.load(std::memory_order_relaxed);
+    st.unshared = g_unshared.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(g_isolatedMutex);
+    st.isolated = g_isolated.size();
+    return st;
+}
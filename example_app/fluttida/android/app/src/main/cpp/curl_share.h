@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Process-wide CURLSH sharing the DNS cache, TLS session cache and the
+// connection pool between every easy handle (and thus every JNI thread).
+//
+// curl's connection reuse and session resumption know nothing about the pins
+// checked in CURLOPT_SSL_CTX_FUNCTION: a pinned request that picked up a
+// connection or session negotiated by an unpinned (or differently pinned) one
+// would never run its verify callback. Pinned handles therefore attach to a
+// separate share per pin configuration; when none can be had they opt out of
+// reuse altogether (FORBID_REUSE, FRESH_CONNECT, no session-ID cache), since the
+// multi engine would otherwise pool their connections with everyone else's.
+//
+// Each curl_lock_data type has its own mutex per share so a DNS lookup on one
+// thread never waits on a connection-cache walk on another.
+
+struct ShareStats {
+    // Lock acquisitions per shared cache, i.e. how often transfers contend for it;
+    // they are not cache hits (real hits: connReused, tlsResumed, DnsStats::hits)
+    uint64_t dnsLockAcquisitions;
+    uint64_t sslSessionLockAcquisitions;
+    uint64_t connectLockAcquisitions;
+    uint64_t connReused;        // transfers that found a live connection
+    uint64_t connNew;           // transfers that had to connect
+    uint64_t tlsResumed;        // new TLS connections that resumed a cached session
+    uint64_t tlsFull;           // new TLS connections with a full handshake
+    size_t isolated;            // per-pin-configuration shares
+    uint64_t unshared;          // pinned transfers that ran without reuse (no share available)
+};
+
+// Per-transfer probe filled from CURLOPT_PREREQFUNCTION once the connection is up
+struct ShareProbe {
+    void* curl = nullptr;
+    int tlsResumed = -1;        // -1 unknown / plain HTTP, 0 full handshake, 1 resumed
+    // Optional check on the negotiated TLS session (SSL*, nullptr for plain HTTP or a
+    // non-OpenSSL backend). Runs for new and reused connections before the request is
+    // sent; returning false aborts the transfer with CURLE_ABORTED_BY_CALLBACK.
+    bool (*tlsCheck)(void* ssl, void* data) = nullptr;
+    void* tlsCheckData = nullptr;
+};
+
+// Returns the shared handle, creating it on first use; nullptr if unsupported.
+void* curl_share();
+
+// Attaches the share handle for isolationKey (empty = the global share; pinned requests
+// pass their pin configuration) and the resumption probe to an easy handle. Returns
+// false if the probe could not be installed (libcurl without CURLOPT_PREREQFUNCTION).
+bool curl_share_attach(void* curl, ShareProbe* probe, const std::string& isolationKey = std::string());
+
+// Folds the outcome of a finished transfer into the counters.
+void curl_share_record(void* curl, const ShareProbe* probe);
+
+ShareStats curl_share_stats();
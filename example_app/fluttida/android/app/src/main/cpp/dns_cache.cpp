@@ -0,0 +1,328 @@
+#include "dns_cache.h"
+#include "native_log.h"
+
+#include <arpa/inet.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kDefaultTtlSeconds = 60;
+constexpr int kNegativeTtlSeconds = 5;
+constexpr size_t kMaxEntries = 256;
+
+struct Entry {
+    std::vector<DnsAddress> addrs;  // port 0
+    Clock::time_point expires;
+    bool resolving = false;
+    bool failed = false;
+};
+
+struct Cache {
+    std::mutex mutex;
+    std::condition_variable resolved;
+    std::unordered_map<std::string, Entry> entries;
+    bool enabled = true;
+    int ttlSeconds = kDefaultTtlSeconds;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t coalesced = 0;
+    uint64_t failures = 0;
+    uint64_t prefetches = 0;
+    uint64_t lookupUs = 0;
+
+    // prefetch worker
+    std::deque<std::string> queue;
+    std::condition_variable queued;
+    bool workerStarted = false;
+};
+
+Cache& cache() {
+    // Never destroyed: the prefetch worker may still be running at exit
+    static Cache* c = new Cache();
+    return *c;
+}
+
+std::string lower_host(const std::string& host) {
+    std::string key = host;
+    for (char& ch : key) {
+        if (ch >= 'A' && ch <= 'Z') ch = (char)(ch - 'A' + 'a');
+    }
+    return key;
+}
+
+void set_port(DnsAddress& a, int port) {
+    if (a.family == AF_INET) ((sockaddr_in*)&a.addr)->sin_port = htons((uint16_t)port);
+    else if (a.family == AF_INET6) ((sockaddr_in6*)&a.addr)->sin6_port = htons((uint16_t)port);
+}
+
+// Numeric hosts ("1.2.3.4", "::1", "[::1]") bypass the cache
+bool parse_literal(const std::string& host, DnsAddress* out) {
+    std::string h = host;
+    if (h.size() > 2 && h.front() == '[' && h.back() == ']') h = h.substr(1, h.size() - 2);
+    DnsAddress a;
+    memset(&a.addr, 0, sizeof(a.addr));
+    auto* v4 = (sockaddr_in*)&a.addr;
+    auto* v6 = (sockaddr_in6*)&a.addr;
+    if (inet_pton(AF_INET, h.c_str(), &v4->sin_addr) == 1) {
+        v4->sin_family = AF_INET;
+        a.family = AF_INET;
+        a.len = sizeof(sockaddr_in);
+    } else if (inet_pton(AF_INET6, h.c_str(), &v6->sin6_addr) == 1) {
+        v6->sin6_family = AF_INET6;
+        a.family = AF_INET6;
+        a.len = sizeof(sockaddr_in6);
+    } else {
+        return false;
+    }
+    *out = a;
+    return true;
+}
+
+// getaddrinfo outside the lock; addresses are returned with port 0, duplicates dropped
+bool lookup(const std::string& host, std::vector<DnsAddress>* out, uint64_t* tookUs) {
+    struct addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_ADDRCONFIG;
+    struct addrinfo* res0 = nullptr;
+    auto begin = Clock::now();
+    int rc = getaddrinfo(host.c_str(), nullptr, &hints, &res0);
+    *tookUs = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - begin).count();
+    if (rc != 0) {
+        LOGE("dns_cache: getaddrinfo(%s) failed: %s", host.c_str(), gai_strerror(rc));
+        return false;
+    }
+    for (struct addrinfo* rp = res0; rp; rp = rp->ai_next) {
+        if ((rp->ai_family != AF_INET && rp->ai_family != AF_INET6) || rp->ai_addrlen > sizeof(sockaddr_storage)) continue;
+        DnsAddress a;
+        memset(&a.addr, 0, sizeof(a.addr));
+        memcpy(&a.addr, rp->ai_addr, rp->ai_addrlen);
+        a.len = (socklen_t)rp->ai_addrlen;
+        a.family = rp->ai_family;
+        set_port(a, 0);
+        bool dup = false;
+        for (const DnsAddress& e : *out) {
+            if (e.len == a.len && memcmp(&e.addr, &a.addr, a.len) == 0) dup = true;
+        }
+        if (!dup) out->push_back(a);
+    }
+    freeaddrinfo(res0);
+    return !out->empty();
+}
+
+// Drops expired entries (or the oldest ones) once the map is full; caller holds the mutex
+void evict_locked(Cache& c) {
+    if (c.entries.size() < kMaxEntries) return;
+    auto now = Clock::now();
+    auto oldest = c.entries.end();
+    for (auto it = c.entries.begin(); it != c.entries.end();) {
+        if (!it->second.resolving && it->second.expires <= now) {
+            it = c.entries.erase(it);
+            continue;
+        }
+        if (!it->second.resolving && (oldest == c.entries.end() || it->second.expires < oldest->second.expires)) oldest = it;
+        ++it;
+    }
+    if (c.entries.size() >= kMaxEntries && oldest != c.entries.end()) c.entries.erase(oldest);
+}
+
+// Cached addresses (port 0) for host, resolving or waiting on a miss
+bool resolve_cached(const std::string& host, bool prefetch, std::vector<DnsAddress>* out) {
+    Cache& c = cache();
+    std::string key = lower_host(host);
+    std::unique_lock<std::mutex> lock(c.mutex);
+    bool waited = false;
+    for (;;) {
+        auto it = c.entries.find(key);
+        if (it == c.entries.end()) break;
+        Entry& e = it->second;
+        if (e.resolving) {
+            if (!waited) ++c.coalesced;
+            waited = true;
+            c.resolved.wait(lock);
+            continue;
+        }
+        if (e.expires > Clock::now()) {
+            if (!waited && !prefetch) ++c.hits;
+            if (e.failed) return false;
+            *out = e.addrs;
+            return true;
+        }
+        break; // expired: refresh below
+    }
+    evict_locked(c);
+    c.entries[key].resolving = true;
+    if (prefetch) ++c.prefetches;
+    else ++c.misses;
+    lock.unlock();
+
+    std::vector<DnsAddress> addrs;
+    uint64_t tookUs = 0;
+    bool ok = lookup(host, &addrs, &tookUs);
+
+    lock.lock();
+    c.lookupUs += tookUs;
+    Entry& e = c.entries[key];
+    e.resolving = false;
+    e.failed = !ok;
+    e.addrs = addrs;
+    e.expires = Clock::now() + std::chrono::seconds(ok ? c.ttlSeconds : kNegativeTtlSeconds);
+    if (!ok) ++c.failures;
+    c.resolved.notify_all();
+    if (ok) *out = std::move(addrs);
+    return ok;
+}
+
+// Fresh cache entry for host without resolving or waiting: false on a miss, an
+// expired entry or a lookup still in flight. *ok is false for a negative entry.
+// A disabled cache has nothing to look up, so it answers true with *ok false.
+bool peek_cached(const std::string& host, std::vector<DnsAddress>* out, bool* ok) {
+    Cache& c = cache();
+    std::lock_guard<std::mutex> lock(c.mutex);
+    *ok = false;
+    if (!c.enabled) return true;
+    auto it = c.entries.find(lower_host(host));
+    if (it == c.entries.end() || it->second.resolving || it->second.expires <= Clock::now()) return false;
+    ++c.hits;
+    if (it->second.failed) return true;
+    *out = it->second.addrs;
+    *ok = true;
+    return true;
+}
+
+// "+host:port:addr,..." for CURLOPT_RESOLVE; "+" marks the entry as expiring in
+// curl's DNS cache instead of pinning it forever
+std::string curl_resolve_entry(const std::string& host, int port, const std::vector<DnsAddress>& addrs) {
+    std::string entry = "+" + host + ":" + std::to_string(port) + ":";
+    char buf[INET6_ADDRSTRLEN];
+    bool first = true;
+    for (const DnsAddress& a : addrs) {
+        const void* src = a.family == AF_INET ? (const void*)&((const sockaddr_in*)&a.addr)->sin_addr
+                                              : (const void*)&((const sockaddr_in6*)&a.addr)->sin6_addr;
+        if (!inet_ntop(a.family, src, buf, sizeof(buf))) continue;
+        if (!first) entry += ',';
+        first = false;
+        if (a.family == AF_INET6) entry += '[';
+        entry += buf;
+        if (a.family == AF_INET6) entry += ']';
+    }
+    return entry;
+}
+
+void prefetch_worker() {
+    Cache& c = cache();
+    for (;;) {
+        std::string host;
+        {
+            std::unique_lock<std::mutex> lock(c.mutex);
+            c.queued.wait(lock, [&c] { return !c.queue.empty(); });
+            host = std::move(c.queue.front());
+            c.queue.pop_front();
+            if (!c.enabled) continue;
+        }
+        std::vector<DnsAddress> ignored;
+        resolve_cached(host, true, &ignored);
+    }
+}
+
+} // namespace
+
+bool dns_resolve(const std::string& host, int port, std::vector<DnsAddress>* out) {
+    out->clear();
+    DnsAddress literal;
+    if (parse_literal(host, &literal)) {
+        set_port(literal, port);
+        out->push_back(literal);
+        return true;
+    }
+    bool ok;
+    if (dns_cache_enabled()) {
+        ok = resolve_cached(host, false, out);
+    } else {
+        uint64_t tookUs = 0;
+        ok = lookup(host, out, &tookUs);
+    }
+    for (DnsAddress& a : *out) set_port(a, port);
+    return ok;
+}
+
+std::string dns_curl_resolve_entry(const std::string& host, int port) {
+    DnsAddress literal;
+    if (host.empty() || parse_literal(host, &literal) || !dns_cache_enabled()) return std::string();
+    std::vector<DnsAddress> addrs;
+    if (!resolve_cached(host, false, &addrs)) return std::string();
+    return curl_resolve_entry(host, port, addrs);
+}
+
+bool dns_curl_cached_entry(const std::string& host, int port, std::string* entry) {
+    entry->clear();
+    DnsAddress literal;
+    if (host.empty() || parse_literal(host, &literal)) return true;
+    std::vector<DnsAddress> addrs;
+    bool ok = false;
+    if (!peek_cached(host, &addrs, &ok)) return false;
+    if (ok) *entry = curl_resolve_entry(host, port, addrs);
+    return true;
+}
+
+void dns_prefetch(const std::vector<std::string>& hosts) {
+    Cache& c = cache();
+    std::lock_guard<std::mutex> lock(c.mutex);
+    if (!c.enabled) return;
+    for (const std::string& h : hosts) {
+        DnsAddress literal;
+        if (!h.empty() && !parse_literal(h, &literal)) c.queue.push_back(h);
+    }
+    if (!c.workerStarted) {
+        c.workerStarted = true;
+        std::thread(prefetch_worker).detach();
+    }
+    c.queued.notify_one();
+}
+
+bool dns_cache_enabled() {
+    std::lock_guard<std::mutex> lock(cache().mutex);
+    return cache().enabled;
+}
+
+void dns_configure(bool enabled, int ttlSeconds) {
+    Cache& c = cache();
+    std::lock_guard<std::mutex> lock(c.mutex);
+    c.enabled = enabled;
+    if (ttlSeconds > 0) c.ttlSeconds = ttlSeconds;
+    if (!enabled) {
+        // keep entries that are mid-lookup: their resolver still writes to them
+        for (auto it = c.entries.begin(); it != c.entries.end();) {
+            if (it->second.resolving) ++it;
+            else it = c.entries.erase(it);
+        }
+        c.queue.clear();
+    }
+    LOGI("dns_cache: enabled=%d ttl=%ds", enabled ? 1 : 0, c.ttlSeconds);
+}
+
+DnsStats dns_cache_stats() {
+    Cache& c = cache();
+    std::lock_guard<std::mutex> lock(c.mutex);
+    DnsStats st{};
+    st.hits = c.hits;
+    st.misses = c.misses;
+    st.coalesced = c.coalesced;
+    st.failures = c.failures;
+    st.prefetches = c.prefetches;
+    st.lookupUs = c.lookupUs;
+    st.entries = c.entries.size();
+    st.ttlSeconds = c.ttlSeconds;
+    st.enabled = c.enabled;
+    return st;
+}
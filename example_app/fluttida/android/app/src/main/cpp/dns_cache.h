@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <sys/socket.h>
+
+// Process-wide resolver cache shared by the pinning preflight and curl.
+//
+// Lookups go through getaddrinfo once per host and TTL; concurrent lookups of
+// the same host wait for the first one instead of resolving again. curl is fed
+// the cached answer with CURLOPT_RESOLVE ("+host:port:addr,...", so the entry
+// also expires normally in curl's own cache). getaddrinfo does not expose record
+// TTLs, so every entry lives for the configured TTL (failures for a short
+// negative TTL). dns_prefetch warms entries on a background thread.
+
+struct DnsAddress {
+    sockaddr_storage addr;      // port already set for the lookup
+    socklen_t len = 0;
+    int family = 0;             // AF_INET / AF_INET6
+};
+
+struct DnsStats {
+    uint64_t hits;              // answered from the cache
+    uint64_t misses;            // had to call getaddrinfo
+    uint64_t coalesced;         // waited for a lookup already in flight
+    uint64_t failures;          // getaddrinfo errors (negative-cached)
+    uint64_t prefetches;        // lookups started by dns_prefetch
+    uint64_t lookupUs;          // total time spent in getaddrinfo
+    size_t entries;
+    int ttlSeconds;
+    bool enabled;
+};
+
+// Cached addresses for host with port filled in, in getaddrinfo order. IP literals
+// are parsed without touching the cache. Returns false when resolution failed.
+bool dns_resolve(const std::string& host, int port, std::vector<DnsAddress>* out);
+
+// CURLOPT_RESOLVE entry for host:port from the cache (resolving on a miss), or ""
+// when the cache is disabled, host is an IP literal or resolution failed.
+std::string dns_curl_resolve_entry(const std::string& host, int port);
+
+// Non-blocking form of dns_curl_resolve_entry for the submitting thread: sets *entry
+// from a fresh cache hit and returns true when nothing is left to resolve (also for
+// IP literals, a disabled cache or a negative entry, with *entry left empty).
+// Returns false on a miss, which the caller resolves off-thread.
+bool dns_curl_cached_entry(const std::string& host, int port, std::string* entry);
+
+// Queues background lookups so later requests hit the cache.
+void dns_prefetch(const std::vector<std::string>& hosts);
+
+bool dns_cache_enabled();
+
+// ttlSeconds <= 0 keeps the current TTL. Disabling also clears the cache.
+void dns_configure(bool enabled, int ttlSeconds);
+
+DnsStats dns_cache_stats();
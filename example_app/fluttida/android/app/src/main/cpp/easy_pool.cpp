@@ -0,0 +1,100 @@
+#include "easy_pool.h"
+#include "native_api.h"
+#include "native_log.h"
+
+#include <cctype>
+
+EasyPool::EasyPool(size_t maxIdlePerKey, size_t maxIdleTotal)
+    : maxIdlePerKey_(maxIdlePerKey), maxIdleTotal_(maxIdleTotal) {}
+
+EasyPool::~EasyPool() {
+    const CurlApi& curlApi = native_api().curl;
+    for (auto& e : idle_) {
+        if (curlApi.easy_cleanup) curlApi.easy_cleanup(e.second);
+    }
+}
+
+void* EasyPool::acquire(const std::string& key) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = idle_.begin(); it != idle_.end(); ++it) {
+            if (it->first == key) {
+                void* curl = it->second;
+                idle_.erase(it);
+                ++hits_;
+                return curl;
+            }
+        }
+        ++misses_;
+    }
+    const NativeApi& api = native_api();
+    if (!api.has(NATIVE_CAP_CURL)) return nullptr;
+    return api.curl.easy_init();
+}
+
+void EasyPool::release(const std::string& key, void* curl, bool reusable) {
+    if (!curl) return;
+    const CurlApi& curlApi = native_api().curl;
+    // Without curl_easy_reset we cannot scrub per-request options, so don't pool
+    if (!reusable || !curlApi.easy_reset || maxIdleTotal_ == 0) {
+        curlApi.easy_cleanup(curl);
+        return;
+    }
+    // Drop pointers into the finished request's stack (WRITEDATA, SSL_CTX_DATA, ...)
+    curlApi.easy_reset(curl);
+
+    void* evicted = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t sameKey = 0;
+        for (auto& e : idle_) {
+            if (e.first == key) ++sameKey;
+        }
+        if (sameKey >= maxIdlePerKey_) {
+            evicted = curl;
+        } else {
+            idle_.emplace_front(key, curl);
+            if (idle_.size() > maxIdleTotal_) {
+                evicted = idle_.back().second;
+                idle_.pop_back();
+            }
+        }
+        if (evicted) ++evictions_;
+    }
+    if (evicted) curlApi.easy_cleanup(evicted);
+}
+
+EasyPoolStats EasyPool::stats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return EasyPoolStats{hits_, misses_, evictions_, idle_.size()};
+}
+
+EasyPool& easy_pool() {
+    // Intentionally leaked: handles must outlive late JNI calls during process teardown
+    static EasyPool* pool = new EasyPool(4, 16);
+    return *pool;
+}
+
+std::string easy_pool_key(const char* url, const std::string& pinConfig) {
+    std::string urlstr(url ? url : "");
+    std::string scheme = "http";
+    size_t pos = urlstr.find("://");
+    size_t start = 0;
+    if (pos != std::string::npos) {
+        scheme = urlstr.substr(0, pos);
+        start = pos + 3;
+    }
+    size_t end = urlstr.find_first_of("/?#", start);
+    std::string authority = (end == std::string::npos) ? urlstr.substr(start) : urlstr.substr(start, end - start);
+    size_t at = authority.rfind('@');
+    if (at != std::string::npos) authority = authority.substr(at + 1);
+    for (auto& ch : scheme) ch = (char)tolower((unsigned char)ch);
+    for (auto& ch : authority) ch = (char)tolower((unsigned char)ch);
+    // Append the default port so "host" and "host:443" share handles
+    size_t colon = authority.rfind(':');
+    size_t bracket = authority.rfind(']');
+    if (colon == std::string::npos || (bracket != std::string::npos && colon < bracket)) {
+        authority += (scheme == "https") ? ":443" : ":80";
+    }
+    return scheme + "://" + authority + "|" + pinConfig;
+}
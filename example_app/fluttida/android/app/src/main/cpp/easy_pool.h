@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <utility>
+
+// Bounded pool of reusable curl easy handles.
+//
+// Handles are keyed by scheme+host+port+pin-config so a kept-alive
+// connection is only ever reused by a request that would have negotiated
+// (and pin-checked) it the same way. Handles are curl_easy_reset() when
+// they come back, which clears all options but keeps the connection and
+// TLS session cache attached to the handle.
+
+struct EasyPoolStats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    size_t idle;
+};
+
+class EasyPool {
+public:
+    EasyPool(size_t maxIdlePerKey, size_t maxIdleTotal);
+    ~EasyPool();
+
+    // Returns an idle handle for key, or a fresh one. nullptr if curl is unavailable.
+    void* acquire(const std::string& key);
+    // Hands a handle back. Non-reusable handles (or overflow) are cleaned up.
+    void release(const std::string& key, void* curl, bool reusable = true);
+
+    EasyPoolStats stats();
+
+private:
+    std::mutex mutex_;
+    std::list<std::pair<std::string, void*>> idle_; // most recently used first
+    size_t maxIdlePerKey_;
+    size_t maxIdleTotal_;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+    uint64_t evictions_ = 0;
+};
+
+// Process-wide pool used by nativeHttpRequest
+EasyPool& easy_pool();
+
+// Builds "scheme://host:port|pinConfig" (host lower-cased, default port filled in)
+std::string easy_pool_key(const char* url, const std::string& pinConfig);
@@ -0,0 +1,140 @@
+#include "happy_eyeballs.h"
+#include "native_log.h"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using Clock = std::chrono::steady_clock;
+
+static std::atomic<uint64_t> g_v6Wins{0};
+static std::atomic<uint64_t> g_v4Wins{0};
+static std::atomic<uint64_t> g_failures{0};
+static std::atomic<uint64_t> g_timeouts{0};
+
+// RFC 8305 section 4: alternate families, starting with the first address's family
+static std::vector<const DnsAddress*> interleave(const std::vector<DnsAddress>& addrs) {
+    std::vector<const DnsAddress*> first, second, out;
+    if (addrs.empty()) return out;
+    int firstFamily = addrs[0].family;
+    for (const DnsAddress& a : addrs) (a.family == firstFamily ? first : second).push_back(&a);
+    for (size_t i = 0; i < first.size() || i < second.size(); ++i) {
+        if (i < first.size()) out.push_back(first[i]);
+        if (i < second.size()) out.push_back(second[i]);
+    }
+    return out;
+}
+
+static int start_attempt(const DnsAddress& a, int* err) {
+    int fd = socket(a.family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        *err = errno;
+        return -1;
+    }
+    if (connect(fd, (const sockaddr*)&a.addr, a.len) == 0 || errno == EINPROGRESS) return fd;
+    *err = errno;
+    close(fd);
+    return -1;
+}
+
+static void set_blocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags >= 0) fcntl(fd, F_SETFL, flags & ~O_NONBLOCK);
+}
+
+static int64_t ms_until(Clock::time_point t, Clock::time_point now) {
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t - now).count();
+    return ms < 0 ? 0 : ms;
+}
+
+ConnectResult happy_eyeballs_connect(const std::vector<DnsAddress>& addrs, int timeoutMs, int attemptDelayMs) {
+    ConnectResult r;
+    const Clock::time_point begin = Clock::now();
+    const bool hasDeadline = timeoutMs > 0;
+    const Clock::time_point deadline = begin + std::chrono::milliseconds(timeoutMs > 0 ? timeoutMs : 0);
+    std::vector<const DnsAddress*> order = interleave(addrs);
+
+    struct Pending { int fd; int family; };
+    std::vector<Pending> pending;
+    size_t next = 0;
+    Clock::time_point nextStart = begin;
+
+    while (r.fd < 0) {
+        Clock::time_point now = Clock::now();
+        if (hasDeadline && now >= deadline) {
+            r.timedOut = true;
+            break;
+        }
+        // Start the next attempt when its delay has passed or nothing is in flight
+        if (next < order.size() && (pending.empty() || now >= nextStart)) {
+            const DnsAddress* a = order[next++];
+            int fd = start_attempt(*a, &r.error);
+            if (fd < 0) continue; // immediate failure: move on without waiting
+            ++r.attempts;
+            pending.push_back({fd, a->family});
+            nextStart = now + std::chrono::milliseconds(attemptDelayMs);
+        }
+        if (pending.empty()) {
+            if (next >= order.size()) break; // every address failed
+            continue;
+        }
+
+        int64_t waitMs = -1;
+        if (next < order.size()) waitMs = ms_until(nextStart, now);
+        if (hasDeadline) {
+            int64_t left = ms_until(deadline, now);
+            waitMs = waitMs < 0 ? left : (left < waitMs ? left : waitMs);
+        }
+        std::vector<pollfd> fds(pending.size());
+        for (size_t i = 0; i < pending.size(); ++i) fds[i] = {pending[i].fd, POLLOUT, 0};
+        int n = poll(fds.data(), (nfds_t)fds.size(), (int)waitMs);
+        if (n < 0 && errno != EINTR) {
+            r.error = errno;
+            break;
+        }
+        for (size_t i = fds.size(); n > 0 && i-- > 0;) {
+            if (!fds[i].revents) continue;
+            int soErr = 0;
+            socklen_t len = sizeof(soErr);
+            if (getsockopt(pending[i].fd, SOL_SOCKET, SO_ERROR, &soErr, &len) != 0) soErr = errno;
+            if (soErr == 0 && r.fd < 0) {
+                r.fd = pending[i].fd;
+                r.family = pending[i].family;
+            } else {
+                if (soErr != 0) r.error = soErr;
+                close(pending[i].fd);
+            }
+            pending.erase(pending.begin() + (long)i);
+            // a failure frees the slot: the next address may start right away
+            if (soErr != 0) nextStart = Clock::now();
+        }
+    }
+
+    for (const Pending& p : pending) close(p.fd);
+    r.elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - begin).count();
+    if (r.fd >= 0) {
+        set_blocking(r.fd);
+        r.error = 0;
+        (r.family == AF_INET6 ? g_v6Wins : g_v4Wins).fetch_add(1, std::memory_order_relaxed);
+    } else if (r.timedOut) {
+        g_timeouts.fetch_add(1, std::memory_order_relaxed);
+        LOGE("happy_eyeballs: timed out after %d ms (%d attempts)", timeoutMs, r.attempts);
+    } else {
+        g_failures.fetch_add(1, std::memory_order_relaxed);
+    }
+    return r;
+}
+
+HappyEyeballsStats happy_eyeballs_stats() {
+    HappyEyeballsStats st{};
+    st.v6Wins = g_v6Wins.load(std::memory_order_relaxed);
+    st.v4Wins = g_v4Wins.load(std::memory_order_relaxed);
+    st.failures = g_failures.load(std::memory_order_relaxed);
+    st.timeouts = g_timeouts.load(std::memory_order_relaxed);
+    return st;
+}
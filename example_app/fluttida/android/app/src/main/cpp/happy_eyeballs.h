@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "dns_cache.h"
+
+// Non-blocking TCP connect racing IPv6 and IPv4 (RFC 8305 "Happy Eyeballs v2").
+//
+// Addresses are interleaved by family starting with the family of the first one
+// (getaddrinfo already puts the preferred family first). A new attempt starts
+// every attemptDelayMs, or immediately when the previous one fails; the first
+// socket to connect wins and the others are closed. Nothing ever waits past the
+// deadline, so a blackholed address costs at most one attempt delay.
+
+struct ConnectResult {
+    int fd = -1;                // connected socket in blocking mode, or -1
+    int family = 0;             // AF_INET6 / AF_INET of the winner
+    int error = 0;              // errno of the last failure when fd < 0
+    int attempts = 0;           // sockets started
+    bool timedOut = false;      // deadline hit before any attempt succeeded
+    int64_t elapsedUs = 0;
+};
+
+struct HappyEyeballsStats {
+    uint64_t v6Wins;
+    uint64_t v4Wins;
+    uint64_t failures;
+    uint64_t timeouts;
+};
+
+// timeoutMs <= 0 means no deadline. The caller owns result.fd.
+ConnectResult happy_eyeballs_connect(const std::vector<DnsAddress>& addrs, int timeoutMs,
+                                     int attemptDelayMs = 250);
+
+HappyEyeballsStats happy_eyeballs_stats();
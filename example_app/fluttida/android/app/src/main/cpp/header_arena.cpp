@@ -0,0 +1,112 @@
+#include "header_arena.h"
+
+#include <cstring>
+
+// Kept lowercase and sorted by how often they show up in responses
+static const char* const kCommonNames[] = {
+    "content-type", "content-length", "date", "server", "cache-control", "etag",
+    "last-modified", "expires", "vary", "content-encoding", "connection", "set-cookie",
+    "location", "alt-svc", "server-timing", "strict-transport-security", "age", "accept-ranges",
+    "transfer-encoding", "x-content-type-options", "x-frame-options", "content-security-policy",
+    "access-control-allow-origin", "retry-after", "www-authenticate", "link", "via",
+    "content-disposition", "x-cache", "cf-ray",
+};
+static constexpr size_t kCommonCount = sizeof(kCommonNames) / sizeof(kCommonNames[0]);
+
+static inline char lower(char c) {
+    return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+}
+
+// a (any case, length n) equals the lowercase NUL-terminated b
+static bool equals_lower(const char* a, size_t n, const char* b) {
+    for (size_t i = 0; i < n; ++i) {
+        if (b[i] == '\0' || lower(a[i]) != b[i]) return false;
+    }
+    return b[n] == '\0';
+}
+
+size_t header_common_count() {
+    return kCommonCount;
+}
+
+const char* header_common_name(int id) {
+    return (id >= 0 && (size_t)id < kCommonCount) ? kCommonNames[id] : nullptr;
+}
+
+int header_intern(const char* name, size_t len) {
+    for (size_t i = 0; i < kCommonCount; ++i) {
+        if (equals_lower(name, len, kCommonNames[i])) return (int)i;
+    }
+    return kHeaderNotInterned;
+}
+
+void HeaderArena::setWanted(std::vector<std::string> names) {
+    wanted_.clear();
+    wantedIds_.clear();
+    all_ = false;
+    for (std::string& n : names) {
+        if (n == "*") {
+            all_ = true;
+            continue;
+        }
+        for (char& c : n) c = lower(c);
+        int id = header_intern(n.data(), n.size());
+        if (id != kHeaderNotInterned) wantedIds_.push_back(id);
+        else wanted_.push_back(std::move(n));
+    }
+}
+
+bool HeaderArena::wanted(const char* name, size_t len, int interned) const {
+    if (all_) return true;
+    if (interned != kHeaderNotInterned) {
+        for (int id : wantedIds_) {
+            if (id == interned) return true;
+        }
+        return false;
+    }
+    for (const std::string& w : wanted_) {
+        if (equals_lower(name, len, w.c_str())) return true;
+    }
+    return false;
+}
+
+size_t HeaderArena::write(char* buffer, size_t size, size_t nitems, void* userdata) {
+    auto* a = (HeaderArena*)userdata;
+    size_t total = size * nitems;
+    const char* p = buffer;
+    size_t n = total;
+    while (n > 0 && (p[n - 1] == '\r' || p[n - 1] == '\n')) --n;
+
+    if (n >= 5 && memcmp(p, "HTTP/", 5) == 0) {
+        // status line of a new response: drop whatever the previous one left
+        a->buf_.clear();
+        a->fields_.clear();
+        return total;
+    }
+    if (n == 0 || p[0] == ' ' || p[0] == '\t') return total; // end of block / obsolete folding
+
+    const char* colon = (const char*)memchr(p, ':', n);
+    if (!colon || colon == p) return total;
+    size_t nameLen = (size_t)(colon - p);
+    int id = header_intern(p, nameLen);
+    if (!a->wanted(p, nameLen, id)) return total;
+
+    const char* v = colon + 1;
+    const char* end = p + n;
+    while (v < end && (*v == ' ' || *v == '\t')) ++v;
+    while (end > v && (end[-1] == ' ' || end[-1] == '\t')) --end;
+
+    Field f;
+    f.interned = id;
+    f.nameOff = (uint32_t)a->buf_.size();
+    f.nameLen = (uint32_t)nameLen;
+    // names are stored lowercase and NUL-terminated, like the values
+    for (size_t i = 0; i < nameLen; ++i) a->buf_.push_back(lower(p[i]));
+    a->buf_.push_back('\0');
+    f.valueOff = (uint32_t)a->buf_.size();
+    f.valueLen = (uint32_t)(end - v);
+    a->buf_.append(v, (size_t)(end - v));
+    a->buf_.push_back('\0');
+    a->fields_.push_back(f);
+    return total;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Response headers captured through CURLOPT_HEADERFUNCTION into one flat buffer.
+//
+// Only the names passed to setWanted() are kept (or all of them with "*"), so a
+// header-heavy response costs one buffer append per wanted line and no per-header
+// allocation. Each new status line (redirects, 1xx, proxy CONNECT) starts over, so
+// the arena ends up holding the final response's headers plus any trailers.
+//
+// Common names are interned: header_intern() maps them to a small id whose
+// canonical lowercase spelling is header_common_name(id), letting the JNI layer reuse
+// one cached jstring per name instead of creating a new one per response.
+
+constexpr int kHeaderNotInterned = -1;
+
+// Number of interned names; ids are [0, header_common_count())
+size_t header_common_count();
+const char* header_common_name(int id);
+// Case-insensitive lookup; kHeaderNotInterned for uncommon names
+int header_intern(const char* name, size_t len);
+
+class HeaderArena {
+public:
+    struct Field {
+        uint32_t nameOff;
+        uint32_t nameLen;
+        uint32_t valueOff;
+        uint32_t valueLen;
+        int interned;           // id from header_intern, or kHeaderNotInterned
+    };
+
+    // names are matched case-insensitively; "*" keeps every header. Empty keeps none.
+    void setWanted(std::vector<std::string> names);
+    bool wantsAny() const { return all_ || !wanted_.empty(); }
+
+    // CURLOPT_HEADERFUNCTION; userdata is the HeaderArena
+    static size_t write(char* buffer, size_t size, size_t nitems, void* userdata);
+
+    size_t size() const { return fields_.size(); }
+    const Field& at(size_t i) const { return fields_[i]; }
+    const char* name(const Field& f) const { return buf_.data() + f.nameOff; }
+    const char* value(const Field& f) const { return buf_.data() + f.valueOff; }
+
+private:
+    bool wanted(const char* name, size_t len, int interned) const;
+
+    std::string buf_;
+    std::vector<Field> fields_;
+    std::vector<std::string> wanted_;   // lowercase
+    std::vector<int> wantedIds_;        // interned ids of wanted_ (fast path)
+    bool all_ = false;
+};
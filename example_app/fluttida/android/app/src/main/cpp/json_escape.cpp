@@ -0,0 +1,166 @@
+#include "json_escape.h"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define JSON_ESCAPE_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define JSON_ESCAPE_NEON 1
+#endif
+
+// Longest output for one input step: a surrogate pair "\uXXXX\uXXXX"
+static constexpr size_t kMaxStep = 12;
+
+static const char kHex[] = "0123456789abcdef";
+
+// Index of the first byte in [p, p+16) that needs attention (< 0x20, '"', '\\' or
+// >= 0x80), or 16 when the whole block can be copied verbatim.
+static inline size_t first_special16(const uint8_t* p) {
+#if defined(JSON_ESCAPE_SSE2)
+    __m128i v = _mm_loadu_si128((const __m128i*)p);
+    // signed compare: bytes >= 0x80 are negative, so one compare covers both ranges
+    __m128i m = _mm_or_si128(_mm_cmplt_epi8(v, _mm_set1_epi8(0x20)),
+                             _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')),
+                                          _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))));
+    unsigned bits = (unsigned)_mm_movemask_epi8(m);
+    return bits ? (size_t)__builtin_ctz(bits) : 16;
+#elif defined(JSON_ESCAPE_NEON)
+    uint8x16_t v = vld1q_u8(p);
+    uint8x16_t m = vorrq_u8(vcltq_s8(vreinterpretq_s8_u8(v), vdupq_n_s8(0x20)),
+                            vorrq_u8(vceqq_u8(v, vdupq_n_u8('"')), vceqq_u8(v, vdupq_n_u8('\\'))));
+#if defined(__aarch64__)
+    // narrow each 0x00/0xFF lane to a nibble: 64-bit mask, 4 bits per byte
+    uint64_t bits = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(m), 4)), 0);
+    return bits ? (size_t)(__builtin_ctzll(bits) >> 2) : 16;
+#else
+    uint8x8_t folded = vorr_u8(vget_low_u8(m), vget_high_u8(m));
+    if (vget_lane_u64(vreinterpret_u64_u8(folded), 0) == 0) return 16;
+    for (size_t i = 0; i < 16; ++i) {
+        uint8_t c = p[i];
+        if (c < 0x20 || c >= 0x80 || c == '"' || c == '\\') return i;
+    }
+    return 16;
+#endif
+#else
+    for (size_t i = 0; i < 16; ++i) {
+        uint8_t c = p[i];
+        if (c < 0x20 || c >= 0x80 || c == '"' || c == '\\') return i;
+    }
+    return 16;
+#endif
+}
+
+static inline char* put_u16(char* w, unsigned cp) {
+    w[0] = '\\';
+    w[1] = 'u';
+    w[2] = kHex[(cp >> 12) & 0xF];
+    w[3] = kHex[(cp >> 8) & 0xF];
+    w[4] = kHex[(cp >> 4) & 0xF];
+    w[5] = kHex[cp & 0xF];
+    return w + 6;
+}
+
+static inline bool is_cont(uint8_t c) { return (c & 0xC0) == 0x80; }
+
+// Handles the special byte at s[i] (plus its continuation bytes). Writes at most
+// kMaxStep bytes to w and returns the number of input bytes consumed.
+static size_t escape_one(const uint8_t* s, size_t i, size_t n, char*& w) {
+    uint8_t c = s[i];
+    if (c < 0x80) {
+        switch (c) {
+            case '"': *w++ = '\\'; *w++ = '"'; break;
+            case '\\': *w++ = '\\'; *w++ = '\\'; break;
+            case '\n': *w++ = '\\'; *w++ = 'n'; break;
+            case '\r': *w++ = '\\'; *w++ = 'r'; break;
+            case '\t': *w++ = '\\'; *w++ = 't'; break;
+            case '\b': *w++ = '\\'; *w++ = 'b'; break;
+            case '\f': *w++ = '\\'; *w++ = 'f'; break;
+            default: w = put_u16(w, c); break;
+        }
+        return 1;
+    }
+    size_t left = n - i;
+    // 2-byte: C2..DF 80..BF
+    if (c >= 0xC2 && c <= 0xDF && left >= 2 && is_cont(s[i + 1])) {
+        w[0] = (char)c;
+        w[1] = (char)s[i + 1];
+        w += 2;
+        return 2;
+    }
+    // 3-byte: E0 A0..BF | E1..EC,EE,EF 80..BF | ED 80..9F (no surrogates), then 80..BF
+    if (c >= 0xE0 && c <= 0xEF && left >= 3 && is_cont(s[i + 1]) && is_cont(s[i + 2])) {
+        uint8_t c1 = s[i + 1];
+        bool ok = (c == 0xE0) ? c1 >= 0xA0 : (c == 0xED) ? c1 <= 0x9F : true;
+        if (ok) {
+            w[0] = (char)c;
+            w[1] = (char)c1;
+            w[2] = (char)s[i + 2];
+            w += 3;
+            return 3;
+        }
+    }
+    // 4-byte: F0 90..BF | F1..F3 80..BF | F4 80..8F, then 2x 80..BF. Modified UTF-8 has no
+    // 4-byte form, so emit the UTF-16 surrogate pair as escapes instead.
+    if (c >= 0xF0 && c <= 0xF4 && left >= 4 && is_cont(s[i + 1]) && is_cont(s[i + 2]) && is_cont(s[i + 3])) {
+        uint8_t c1 = s[i + 1];
+        bool ok = (c == 0xF0) ? c1 >= 0x90 : (c == 0xF4) ? c1 <= 0x8F : true;
+        if (ok) {
+            unsigned cp = ((unsigned)(c & 0x07) << 18) | ((unsigned)(c1 & 0x3F) << 12) |
+                          ((unsigned)(s[i + 2] & 0x3F) << 6) | (unsigned)(s[i + 3] & 0x3F);
+            cp -= 0x10000;
+            w = put_u16(w, 0xD800 + (cp >> 10));
+            w = put_u16(w, 0xDC00 + (cp & 0x3FF));
+            return 4;
+        }
+    }
+    // Invalid lead, stray continuation or truncated sequence: one replacement per byte
+    w = put_u16(w, 0xFFFD);
+    return 1;
+}
+
+void json_escape_append(std::string& out, const char* p, size_t n) {
+    const auto* s = (const uint8_t*)p;
+    size_t base = out.size();
+    // Typical text needs little slack; escape-heavy input regrows below
+    size_t cap = base + n + n / 8 + kMaxStep;
+    out.resize(cap);
+    char* w = &out[base];
+    char* end = &out[0] + cap;
+    size_t i = 0;
+
+    while (i < n) {
+        // Bulk path: copy clean 16-byte blocks
+        while (i + 16 <= n) {
+            if ((size_t)(end - w) < 16 + kMaxStep) break;
+            size_t k = first_special16(s + i);
+            memcpy(w, s + i, 16); // stores past k are overwritten by the escape below
+            w += k;
+            i += k;
+            if (k < 16) break;
+        }
+        if (i >= n) break;
+        if ((size_t)(end - w) < 16 + kMaxStep) {
+            size_t used = (size_t)(w - &out[0]);
+            // Worst case from here is 6 output bytes per input byte
+            size_t need = used + (n - i) * 6 + kMaxStep;
+            size_t grown = cap * 2 < need ? cap * 2 : need;
+            if (grown < used + 16 + kMaxStep) grown = used + 16 + kMaxStep;
+            out.resize(grown);
+            cap = grown;
+            w = &out[0] + used;
+            end = &out[0] + cap;
+            continue;
+        }
+        uint8_t c = s[i];
+        if (c >= 0x20 && c < 0x80 && c != '"' && c != '\\') {
+            *w++ = (char)c; // tail shorter than one block
+            ++i;
+        } else {
+            i += escape_one(s, i, n, w);
+        }
+    }
+    out.resize((size_t)(w - &out[0]));
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Appends p[0..n) to out as the inside of a JSON string literal.
+//
+// The output is pure ASCII plus well-formed BMP UTF-8, so it is valid for both JSON
+// parsers and JNI NewStringUTF (modified UTF-8):
+//   - '"', '\\' and every control character below 0x20 are escaped
+//   - 4-byte sequences (emoji, ...) become \uXXXX\uXXXX surrogate pairs
+//   - invalid, truncated, overlong and surrogate sequences become �
+//
+// Clean runs are scanned 16 bytes at a time (SSE2 on x86, NEON on ARM) and copied in
+// bulk into out, which is sized once up front and only regrown for escape-heavy input.
+void json_escape_append(std::string& out, const char* p, size_t n);
@@ -0,0 +1,156 @@
+#include "log_ring.h"
+
+#include "native_log.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdarg>
+#include <cstdio>
+#include <thread>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace {
+
+static_assert((kLogRingCapacity & (kLogRingCapacity - 1)) == 0, "capacity must be a power of two");
+
+// Lets a burst (one handshake logs several lines back to back) land in one batch
+constexpr useconds_t kCoalesceUs = 5000;
+
+struct Slot {
+    std::atomic<uint64_t> seq;  // == pos: free for producer pos; == pos + 1: readable
+    char text[kLogRecordBytes];
+};
+
+struct Ring {
+    Slot slots[kLogRingCapacity];
+    alignas(64) std::atomic<uint64_t> tail{0};      // next position to claim
+    alignas(64) uint64_t head = 0;                  // drainer only
+    std::atomic<bool> pending{false};               // drainer has been (or will be) woken
+    std::atomic<bool> started{false};
+    int wakefd = -1;
+    std::atomic<uint64_t> pushed{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<uint64_t> delivered{0};
+    std::atomic<uint64_t> batches{0};
+
+    Ring() {
+        for (size_t i = 0; i < kLogRingCapacity; ++i) slots[i].seq.store(i, std::memory_order_relaxed);
+        wakefd = eventfd(0, EFD_CLOEXEC);
+    }
+};
+
+Ring& ring() {
+    // Never destroyed: producers may still log from curl threads at exit
+    static Ring* r = new Ring();
+    return *r;
+}
+
+void wake(Ring& r) {
+    if (r.pending.exchange(true) || r.wakefd < 0) return;
+    uint64_t one = 1;
+    ssize_t n;
+    do {
+        n = write(r.wakefd, &one, sizeof(one));
+    } while (n < 0 && errno == EINTR);
+}
+
+void drain_loop(LogSink sink, void* ctx) {
+    Ring& r = ring();
+    const char* lines[kLogBatchMax];
+    uint64_t reported = 0;
+    for (;;) {
+        uint64_t v;
+        if (r.wakefd >= 0) {
+            if (read(r.wakefd, &v, sizeof(v)) < 0 && errno == EINTR) continue;
+        } else {
+            usleep(50000);
+        }
+        usleep(kCoalesceUs);
+        // Reset before draining: a record published after this point wakes us again
+        r.pending.store(false);
+        for (;;) {
+            size_t n = 0;
+            uint64_t start = r.head;
+            while (n < kLogBatchMax) {
+                Slot& s = r.slots[(start + n) & (kLogRingCapacity - 1)];
+                if (s.seq.load(std::memory_order_acquire) != start + n + 1) break;
+                lines[n++] = s.text;
+            }
+            if (n == 0) break;
+            uint64_t dropped = r.dropped.load(std::memory_order_relaxed);
+            sink(lines, n, dropped - reported, ctx);
+            reported = dropped;
+            // Hand the slots back only after the sink is done reading them
+            for (size_t i = 0; i < n; ++i) {
+                r.slots[(start + i) & (kLogRingCapacity - 1)].seq.store(start + i + kLogRingCapacity,
+                                                                      std::memory_order_release);
+            }
+            r.head = start + n;
+            r.delivered.fetch_add(n, std::memory_order_relaxed);
+            r.batches.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+}  // namespace
+
+bool log_ring_push(const char* fmt, ...) {
+    Ring& r = ring();
+    uint64_t pos = r.tail.load(std::memory_order_relaxed);
+    Slot* s;
+    for (;;) {
+        s = &r.slots[pos & (kLogRingCapacity - 1)];
+        uint64_t seq = s->seq.load(std::memory_order_acquire);
+        int64_t diff = (int64_t)(seq - pos);
+        if (diff == 0) {
+            if (r.tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            r.dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            pos = r.tail.load(std::memory_order_relaxed);
+        }
+    }
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(s->text, sizeof(s->text), fmt, ap);
+    va_end(ap);
+    if (n < 0) {
+        s->text[0] = '\0';
+    } else if ((size_t)n >= sizeof(s->text)) {
+        // don't hand NewStringUTF half of a multi-byte sequence
+        size_t end = sizeof(s->text) - 1;
+        size_t cut = end;
+        while (cut > 0 && ((unsigned char)s->text[cut - 1] & 0xC0) == 0x80) --cut;
+        if (cut > 0 && ((unsigned char)s->text[cut - 1] & 0x80)) {
+            unsigned char lead = (unsigned char)s->text[cut - 1];
+            size_t want = lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : 2;
+            if (end - (cut - 1) < want) s->text[cut - 1] = '\0';
+        }
+    }
+    s->seq.store(pos + 1, std::memory_order_release);
+    r.pushed.fetch_add(1, std::memory_order_relaxed);
+    wake(r);
+    return true;
+}
+
+void log_ring_start(LogSink sink, void* ctx) {
+    Ring& r = ring();
+    if (!sink || r.started.exchange(true)) return;
+    if (r.wakefd < 0) LOGE("log_ring: eventfd failed, drainer falls back to polling");
+    // records pushed before this already signalled the eventfd
+    std::thread(drain_loop, sink, ctx).detach();
+}
+
+LogRingStats log_ring_stats() {
+    Ring& r = ring();
+    LogRingStats st{};
+    st.pushed = r.pushed.load(std::memory_order_relaxed);
+    st.dropped = r.dropped.load(std::memory_order_relaxed);
+    st.delivered = r.delivered.load(std::memory_order_relaxed);
+    st.batches = r.batches.load(std::memory_order_relaxed);
+    st.capacity = kLogRingCapacity;
+    return st;
+}
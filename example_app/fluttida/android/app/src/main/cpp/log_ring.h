@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Bounded multi-producer ring of preformatted log records for the Flutter UI.
+//
+// Producers (TLS verify callbacks, request threads) format straight into a claimed
+// slot and never block or touch JNI: a full ring drops the record and counts it.
+// One drainer thread, started with log_ring_start, wakes on an eventfd (signalled
+// at most once per batch, not per line) and hands records to the sink in batches.
+// Slots use per-slot sequence numbers (Vyukov's bounded queue), so no lock is taken
+// on either side.
+
+constexpr size_t kLogRecordBytes = 248;     // longer records are truncated
+constexpr size_t kLogRingCapacity = 512;    // power of two
+
+struct LogRingStats {
+    uint64_t pushed;        // records accepted
+    uint64_t dropped;       // records lost to a full ring
+    uint64_t delivered;     // records handed to the sink
+    uint64_t batches;       // sink calls
+    size_t capacity;
+};
+
+// Receives up to kLogBatchMax records per call on the drainer thread. dropped is
+// the number of records lost since the previous call.
+constexpr size_t kLogBatchMax = 64;
+typedef void (*LogSink)(const char* const* lines, size_t count, uint64_t dropped, void* ctx);
+
+// printf-style; returns false if the record was dropped
+bool log_ring_push(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+
+// Starts the drainer thread once; later calls are ignored. Records pushed before the
+// start are delivered with the first batch.
+void log_ring_start(LogSink sink, void* ctx);
+
+LogRingStats log_ring_stats();
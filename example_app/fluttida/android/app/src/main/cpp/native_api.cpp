@@ -0,0 +1,228 @@
+#include "native_api.h"
+#include "native_log.h"
+
+#include <dlfcn.h>
+#include <cstdio>
+#include <cstring>
+
+// Subset of curl_version_info_data we read (layout matches CURLVERSION_NOW)
+struct curl_version_info_data_min {
+    int age;
+    const char* version;
+    unsigned int version_num;
+    const char* host;
+    int features;
+    const char* ssl_version;
+    long ssl_version_num;
+    const char* libz_version;
+    const char** protocols;
+};
+
+template <typename T>
+static T sym(void* lib, const char* name) {
+    return lib ? (T)dlsym(lib, name) : nullptr;
+}
+
+static void resolve_curl(NativeApi& api) {
+    void* lib = dlopen("libcurl.so", RTLD_NOW);
+#ifndef __ANDROID__
+    // Desktop distros only ship the unversioned name with the -dev package
+    if (!lib) lib = dlopen("libcurl.so.4", RTLD_NOW);
+#endif
+    if (!lib) {
+        const char* dlerr = dlerror();
+        snprintf(api.curl_load_error, sizeof(api.curl_load_error), "%s", dlerr ? dlerr : "");
+        LOGE("native_api: libcurl.so not found: %s", api.curl_load_error);
+        return;
+    }
+    CurlApi& c = api.curl;
+    c.easy_init = sym<curl_easy_init_t>(lib, "curl_easy_init");
+    c.easy_setopt = sym<curl_easy_setopt_t>(lib, "curl_easy_setopt");
+    c.easy_perform = sym<curl_easy_perform_t>(lib, "curl_easy_perform");
+    c.easy_cleanup = sym<curl_easy_cleanup_t>(lib, "curl_easy_cleanup");
+    c.easy_reset = sym<curl_easy_reset_t>(lib, "curl_easy_reset");
+    c.easy_pause = sym<curl_easy_pause_t>(lib, "curl_easy_pause");
+    c.slist_append = sym<curl_slist_append_t>(lib, "curl_slist_append");
+    c.slist_free_all = sym<curl_slist_free_all_t>(lib, "curl_slist_free_all");
+    c.easy_getinfo = sym<curl_easy_getinfo_t>(lib, "curl_easy_getinfo");
+    c.easy_strerror = sym<curl_easy_strerror_t>(lib, "curl_easy_strerror");
+    c.version_info = sym<curl_version_info_t>(lib, "curl_version_info");
+    c.share_init = sym<curl_share_init_t>(lib, "curl_share_init");
+    c.share_setopt = sym<curl_share_setopt_t>(lib, "curl_share_setopt");
+    c.share_cleanup = sym<curl_share_cleanup_t>(lib, "curl_share_cleanup");
+    c.multi_init = sym<curl_multi_init_t>(lib, "curl_multi_init");
+    c.multi_setopt = sym<curl_multi_setopt_t>(lib, "curl_multi_setopt");
+    c.multi_add_handle = sym<curl_multi_add_handle_t>(lib, "curl_multi_add_handle");
+    c.multi_remove_handle = sym<curl_multi_remove_handle_t>(lib, "curl_multi_remove_handle");
+    c.multi_perform = sym<curl_multi_perform_t>(lib, "curl_multi_perform");
+    c.multi_poll = sym<curl_multi_poll_t>(lib, "curl_multi_poll");
+    c.multi_wakeup = sym<curl_multi_wakeup_t>(lib, "curl_multi_wakeup");
+    c.multi_info_read = sym<curl_multi_info_read_t>(lib, "curl_multi_info_read");
+    c.multi_cleanup = sym<curl_multi_cleanup_t>(lib, "curl_multi_cleanup");
+    c.multi_socket_action = sym<curl_multi_socket_action_t>(lib, "curl_multi_socket_action");
+    c.multi_assign = sym<curl_multi_assign_t>(lib, "curl_multi_assign");
+
+    if (c.easy_init && c.easy_setopt && c.easy_perform && c.easy_cleanup &&
+        c.slist_append && c.slist_free_all && c.easy_getinfo) {
+        api.caps |= NATIVE_CAP_CURL;
+    } else {
+        LOGE("native_api: libcurl symbols missing");
+    }
+    if ((api.caps & NATIVE_CAP_CURL) && c.share_init && c.share_setopt && c.share_cleanup) {
+        api.caps |= NATIVE_CAP_SHARE;
+    }
+    if ((api.caps & NATIVE_CAP_CURL) && c.multi_init && c.multi_setopt && c.multi_add_handle &&
+        c.multi_remove_handle && c.multi_perform && c.multi_poll && c.multi_wakeup &&
+        c.multi_info_read && c.multi_cleanup) {
+        api.caps |= NATIVE_CAP_MULTI;
+    }
+    if ((api.caps & NATIVE_CAP_MULTI) && c.multi_socket_action && c.multi_assign) {
+        api.caps |= NATIVE_CAP_MULTI_SOCKET;
+    }
+
+    if (c.version_info) {
+        auto* ver_info = (curl_version_info_data_min*)c.version_info(3); // CURLVERSION_NOW=3
+        if (ver_info) {
+            if (ver_info->version) api.curl_version = ver_info->version;
+            if (ver_info->ssl_version) api.ssl_version = ver_info->ssl_version;
+        }
+    }
+}
+
+static void resolve_ssl(NativeApi& api) {
+    void* libssl = dlopen("libssl.so", RTLD_LAZY);
+    void* libcrypto = dlopen("libcrypto.so", RTLD_LAZY);
+
+    SslApi& s = api.ssl;
+    s.SSL_CTX_set_verify = sym<SSL_CTX_set_verify_t>(libssl, "SSL_CTX_set_verify");
+    s.TLS_client_method = sym<TLS_client_method_t>(libssl, "TLS_client_method");
+    s.SSL_CTX_new = sym<SSL_CTX_new_t>(libssl, "SSL_CTX_new");
+    s.SSL_new = sym<SSL_new_t>(libssl, "SSL_new");
+    s.SSL_set_tlsext_host_name = sym<SSL_set_tlsext_host_name_t>(libssl, "SSL_set_tlsext_host_name");
+    s.SSL_ctrl = sym<SSL_ctrl_t>(libssl, "SSL_ctrl");
+    s.SSL_set_fd = sym<SSL_set_fd_t>(libssl, "SSL_set_fd");
+    s.SSL_connect = sym<SSL_connect_t>(libssl, "SSL_connect");
+    s.SSL_free = sym<SSL_free_t>(libssl, "SSL_free");
+    s.SSL_CTX_free = sym<SSL_CTX_free_t>(libssl, "SSL_CTX_free");
+    s.SSL_get_peer_certificate = sym<SSL_get_peer_certificate_t>(libssl, "SSL_get_peer_certificate");
+    if (!s.SSL_get_peer_certificate) {
+        // OpenSSL 3 only exports the renamed symbol; same semantics (caller frees the X509)
+        s.SSL_get_peer_certificate = sym<SSL_get_peer_certificate_t>(libssl, "SSL_get1_peer_certificate");
+    }
+    s.SSL_session_reused = sym<SSL_session_reused_t>(libssl, "SSL_session_reused");
+    s.SSL_CTX_get_ex_new_index = sym<SSL_CTX_get_ex_new_index_t>(libssl, "SSL_CTX_get_ex_new_index");
+    s.SSL_CTX_set_ex_data = sym<SSL_CTX_set_ex_data_t>(libssl, "SSL_CTX_set_ex_data");
+    s.SSL_CTX_get_ex_data = sym<SSL_CTX_get_ex_data_t>(libssl, "SSL_CTX_get_ex_data");
+    s.SSL_get_SSL_CTX = sym<SSL_get_SSL_CTX_t>(libssl, "SSL_get_SSL_CTX");
+    s.SSL_get_ex_data_X509_STORE_CTX_idx =
+        sym<SSL_get_ex_data_X509_STORE_CTX_idx_t>(libssl, "SSL_get_ex_data_X509_STORE_CTX_idx");
+    s.SSL_CTX_sess_set_new_cb = sym<SSL_CTX_sess_set_new_cb_t>(libssl, "SSL_CTX_sess_set_new_cb");
+    s.SSL_CTX_sess_get_new_cb = sym<SSL_CTX_sess_get_new_cb_t>(libssl, "SSL_CTX_sess_get_new_cb");
+    s.SSL_CTX_set_info_callback = sym<SSL_CTX_set_info_callback_t>(libssl, "SSL_CTX_set_info_callback");
+    s.SSL_CTX_get_info_callback = sym<SSL_CTX_get_info_callback_t>(libssl, "SSL_CTX_get_info_callback");
+    s.SSL_set_session = sym<SSL_set_session_t>(libssl, "SSL_set_session");
+    s.SSL_get_session = sym<SSL_get_session_t>(libssl, "SSL_get_session");
+    s.SSL_SESSION_free = sym<SSL_SESSION_free_t>(libssl, "SSL_SESSION_free");
+    s.i2d_SSL_SESSION = sym<i2d_SSL_SESSION_t>(libssl, "i2d_SSL_SESSION");
+    s.d2i_SSL_SESSION = sym<d2i_SSL_SESSION_t>(libssl, "d2i_SSL_SESSION");
+    s.SSL_SESSION_get_time = sym<SSL_SESSION_get_time_t>(libssl, "SSL_SESSION_get_time");
+    s.SSL_SESSION_get_timeout = sym<SSL_SESSION_get_timeout_t>(libssl, "SSL_SESSION_get_timeout");
+    s.SSL_SESSION_is_resumable = sym<SSL_SESSION_is_resumable_t>(libssl, "SSL_SESSION_is_resumable");
+    s.SSL_CTX_load_verify_locations =
+        sym<SSL_CTX_load_verify_locations_t>(libssl, "SSL_CTX_load_verify_locations");
+    s.SSL_CTX_set_alpn_protos = sym<SSL_CTX_set_alpn_protos_t>(libssl, "SSL_CTX_set_alpn_protos");
+    s.SSL_CTX_ctrl = sym<SSL_CTX_ctrl_t>(libssl, "SSL_CTX_ctrl");
+    s.SSL_CTX_set_session_cache_mode =
+        sym<SSL_CTX_set_session_cache_mode_t>(libssl, "SSL_CTX_set_session_cache_mode");
+    s.SSL_peek = sym<SSL_peek_t>(libssl, "SSL_peek");
+    s.SSL_get_error = sym<SSL_get_error_t>(libssl, "SSL_get_error");
+    s.SSL_shutdown = sym<SSL_shutdown_t>(libssl, "SSL_shutdown");
+
+    CryptoApi& x = api.crypto;
+    x.X509_STORE_CTX_get_current_cert = sym<X509_STORE_CTX_get_current_cert_t>(libcrypto, "X509_STORE_CTX_get_current_cert");
+    x.X509_STORE_CTX_get_error_depth = sym<X509_STORE_CTX_get_error_depth_t>(libcrypto, "X509_STORE_CTX_get_error_depth");
+    x.X509_STORE_CTX_get_ex_data = sym<X509_STORE_CTX_get_ex_data_t>(libcrypto, "X509_STORE_CTX_get_ex_data");
+    x.CRYPTO_get_ex_new_index = sym<CRYPTO_get_ex_new_index_t>(libcrypto, "CRYPTO_get_ex_new_index");
+    x.i2d_X509 = sym<i2d_X509_t>(libcrypto, "i2d_X509");
+    x.X509_get_pubkey = sym<X509_get_pubkey_t>(libcrypto, "X509_get_pubkey");
+    x.i2d_PUBKEY = sym<i2d_PUBKEY_t>(libcrypto, "i2d_PUBKEY");
+    x.EVP_PKEY_free = sym<EVP_PKEY_free_t>(libcrypto, "EVP_PKEY_free");
+    x.X509_free = sym<X509_free_t>(libcrypto, "X509_free");
+    x.SHA256 = sym<SHA256_fn_t>(libcrypto, "SHA256");
+
+    bool have_hash = x.i2d_X509 && x.X509_get_pubkey && x.i2d_PUBKEY &&
+                     x.EVP_PKEY_free && x.X509_free && x.SHA256;
+
+    if (s.SSL_CTX_set_verify) api.caps |= NATIVE_CAP_SSLCTX;
+    if (have_hash && x.X509_STORE_CTX_get_current_cert && x.X509_STORE_CTX_get_error_depth) {
+        api.caps |= NATIVE_CAP_VERIFY_CB;
+    }
+    if (have_hash && s.TLS_client_method && s.SSL_CTX_new && s.SSL_new && (s.SSL_set_tlsext_host_name || s.SSL_ctrl) &&
+        s.SSL_set_fd && s.SSL_connect && s.SSL_free && s.SSL_CTX_free && s.SSL_get_peer_certificate) {
+        api.caps |= NATIVE_CAP_PREFLIGHT;
+    }
+    if (have_hash && s.SSL_get_peer_certificate) api.caps |= NATIVE_CAP_PEER_PIN;
+    if ((s.SSL_CTX_get_ex_new_index || x.CRYPTO_get_ex_new_index) && s.SSL_CTX_set_ex_data &&
+        s.SSL_CTX_get_ex_data && s.SSL_get_SSL_CTX && s.SSL_get_ex_data_X509_STORE_CTX_idx &&
+        x.X509_STORE_CTX_get_ex_data) {
+        api.caps |= NATIVE_CAP_SSLCTX_DATA;
+    }
+    if ((api.caps & NATIVE_CAP_SSLCTX_DATA) && s.SSL_CTX_sess_set_new_cb && s.SSL_CTX_sess_get_new_cb &&
+        s.SSL_CTX_set_info_callback && s.SSL_CTX_get_info_callback && s.SSL_set_session && s.SSL_get_session &&
+        s.SSL_SESSION_free && s.i2d_SSL_SESSION && s.d2i_SSL_SESSION && s.SSL_SESSION_get_time &&
+        s.SSL_SESSION_get_timeout && s.SSL_session_reused) {
+        api.caps |= NATIVE_CAP_SESSION_STORE;
+    }
+    if ((api.caps & NATIVE_CAP_PREFLIGHT) && (s.SSL_CTX_ctrl || s.SSL_CTX_set_session_cache_mode) &&
+        s.SSL_CTX_sess_set_new_cb && s.SSL_set_session && s.SSL_SESSION_free && s.SSL_session_reused &&
+        s.SSL_peek && s.SSL_get_error && s.SSL_shutdown) {
+        api.caps |= NATIVE_CAP_PREFLIGHT_RESUME;
+    }
+}
+
+static NativeApi build_api() {
+    NativeApi api;
+    memset(&api, 0, sizeof(api));
+    api.curl_version = "unknown";
+    api.ssl_version = "none";
+    resolve_curl(api);
+    resolve_ssl(api);
+    LOGI("native_api: curl version: %s, SSL backend: %s, caps=0x%x",
+         api.curl_version, api.ssl_version, api.caps);
+    return api;
+}
+
+const NativeApi& native_api() {
+    static const NativeApi api = build_api();
+    return api;
+}
+
+int native_ssl_ctx_ex_new_index(CRYPTO_EX_free_t freeFn) {
+    const NativeApi& api = native_api();
+    if (!api.has(NATIVE_CAP_SSLCTX_DATA)) return -1;
+    if (api.ssl.SSL_CTX_get_ex_new_index) {
+        return api.ssl.SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, freeFn);
+    }
+    // CRYPTO_EX_INDEX_SSL_CTX in OpenSSL's crypto.h
+    return api.crypto.CRYPTO_get_ex_new_index(1, 0, nullptr, nullptr, nullptr, freeFn);
+}
+
+bool native_ssl_set_host_name(void* ssl, const char* host) {
+    const SslApi& s = native_api().ssl;
+    if (s.SSL_set_tlsext_host_name) return s.SSL_set_tlsext_host_name(ssl, host) == 1;
+    // SSL_CTRL_SET_TLSEXT_HOSTNAME with TLSEXT_NAMETYPE_host_name in OpenSSL's headers
+    if (s.SSL_ctrl) return s.SSL_ctrl(ssl, 55, 0, const_cast<char*>(host)) == 1;
+    return false;
+}
+
+bool native_ssl_ctx_set_session_cache_mode(void* ctx, int mode) {
+    const NativeApi& api = native_api();
+    if (!ctx || !api.has(NATIVE_CAP_PREFLIGHT_RESUME)) return false;
+    if (api.ssl.SSL_CTX_set_session_cache_mode) {
+        api.ssl.SSL_CTX_set_session_cache_mode(ctx, mode);
+    } else {
+        // SSL_CTRL_SET_SESS_CACHE_MODE in OpenSSL's ssl.h
+        api.ssl.SSL_CTX_ctrl(ctx, 44, mode, nullptr);
+    }
+    return true;
+}
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Runtime-resolved libcurl / libssl / libcrypto entry points.
+//
+// The libraries are dlopen'ed and every symbol is dlsym'ed exactly once
+// (from JNI_OnLoad, or lazily on first use); afterwards the table is
+// immutable and can be read from any thread without locking. The library
+// handles are never dlclose'd to avoid the OpenSSL TLS destructor crash.
+
+// libcurl
+typedef void* (*curl_easy_init_t)();
+typedef int (*curl_easy_setopt_t)(void*, int, ...);
+typedef int (*curl_easy_perform_t)(void*);
+typedef void (*curl_easy_cleanup_t)(void*);
+typedef void (*curl_easy_reset_t)(void*);
+typedef int (*curl_easy_pause_t)(void*, int);
+typedef void* (*curl_slist_append_t)(void*, const char*);
+typedef void (*curl_slist_free_all_t)(void*);
+typedef int (*curl_easy_getinfo_t)(void*, int, ...);
+typedef const char* (*curl_easy_strerror_t)(int);
+typedef void* (*curl_version_info_t)(int);
+typedef void* (*curl_share_init_t)();
+typedef int (*curl_share_setopt_t)(void*, int, ...);
+typedef int (*curl_share_cleanup_t)(void*);
+typedef void* (*curl_multi_init_t)();
+typedef int (*curl_multi_setopt_t)(void*, int, ...);
+typedef int (*curl_multi_add_handle_t)(void*, void*);
+typedef int (*curl_multi_remove_handle_t)(void*, void*);
+typedef int (*curl_multi_perform_t)(void*, int*);
+typedef int (*curl_multi_poll_t)(void*, void*, unsigned int, int, int*);
+typedef int (*curl_multi_wakeup_t)(void*);
+typedef void* (*curl_multi_info_read_t)(void*, int*);
+typedef int (*curl_multi_cleanup_t)(void*);
+typedef int (*curl_multi_socket_action_t)(void*, int, int, int*);
+typedef int (*curl_multi_assign_t)(void*, int, void*);
+
+// libssl
+typedef void (*SSL_CTX_set_verify_t)(void*, int, int(*)(int, void*));
+typedef const void* (*TLS_client_method_t)();
+typedef void* (*SSL_CTX_new_t)(const void*);
+typedef void* (*SSL_new_t)(void*);
+typedef int (*SSL_set_tlsext_host_name_t)(void*, const char*);   // BoringSSL; a macro over SSL_ctrl in OpenSSL
+typedef long (*SSL_ctrl_t)(void*, int, long, void*);
+typedef int (*SSL_set_fd_t)(void*, int);
+typedef int (*SSL_connect_t)(void*);
+typedef void (*SSL_free_t)(void*);
+typedef void (*SSL_CTX_free_t)(void*);
+typedef void* (*SSL_get_peer_certificate_t)(void*);
+typedef int (*SSL_session_reused_t)(const void*);
+typedef void (*CRYPTO_EX_free_t)(void* parent, void* ptr, void* ad, int idx, long argl, void* argp);
+typedef int (*SSL_CTX_get_ex_new_index_t)(long, void*, void*, void*, CRYPTO_EX_free_t); // BoringSSL
+typedef int (*SSL_CTX_set_ex_data_t)(void*, int, void*);
+typedef void* (*SSL_CTX_get_ex_data_t)(const void*, int);
+typedef void* (*SSL_get_SSL_CTX_t)(const void*);
+typedef int (*SSL_get_ex_data_X509_STORE_CTX_idx_t)();
+typedef int (*SSL_new_session_cb_t)(void* ssl, void* session);
+typedef void (*SSL_info_cb_t)(const void* ssl, int where, int ret);
+typedef void (*SSL_CTX_sess_set_new_cb_t)(void*, SSL_new_session_cb_t);
+typedef SSL_new_session_cb_t (*SSL_CTX_sess_get_new_cb_t)(void*);
+typedef void (*SSL_CTX_set_info_callback_t)(void*, SSL_info_cb_t);
+typedef SSL_info_cb_t (*SSL_CTX_get_info_callback_t)(void*);
+typedef int (*SSL_set_session_t)(void*, void*);
+typedef void* (*SSL_get_session_t)(const void*);
+typedef void (*SSL_SESSION_free_t)(void*);
+typedef int (*i2d_SSL_SESSION_t)(void*, unsigned char**);
+typedef void* (*d2i_SSL_SESSION_t)(void**, const unsigned char**, long);
+typedef long (*SSL_SESSION_get_time_t)(const void*);     // uint64_t in BoringSSL; seconds fit either way
+typedef long (*SSL_SESSION_get_timeout_t)(const void*);
+typedef int (*SSL_SESSION_is_resumable_t)(const void*);
+typedef int (*SSL_CTX_load_verify_locations_t)(void*, const char*, const char*);
+typedef int (*SSL_CTX_set_alpn_protos_t)(void*, const unsigned char*, unsigned);
+typedef long (*SSL_CTX_ctrl_t)(void*, int, long, void*);                   // OpenSSL
+typedef int (*SSL_CTX_set_session_cache_mode_t)(void*, int);                // BoringSSL
+typedef int (*SSL_peek_t)(void*, void*, int);
+typedef int (*SSL_get_error_t)(const void*, int);
+typedef int (*SSL_shutdown_t)(void*);
+
+// libcrypto
+typedef unsigned char* (*SHA256_fn_t)(const unsigned char*, size_t, unsigned char*);
+typedef int (*i2d_X509_t)(void*, unsigned char**);
+typedef int (*i2d_PUBKEY_t)(void*, unsigned char**);
+typedef void* (*X509_get_pubkey_t)(void*);
+typedef void (*EVP_PKEY_free_t)(void*);
+typedef void (*X509_free_t)(void*);
+typedef void* (*X509_STORE_CTX_get_current_cert_t)(void*);
+typedef int (*X509_STORE_CTX_get_error_depth_t)(void*);
+typedef void* (*X509_STORE_CTX_get_ex_data_t)(const void*, int);
+typedef int (*CRYPTO_get_ex_new_index_t)(int, long, void*, void*, void*, CRYPTO_EX_free_t);
+
+// Capability bits: set only when every symbol the feature needs was resolved
+enum : uint32_t {
+    NATIVE_CAP_CURL         = 1u << 0, // core easy API usable
+    NATIVE_CAP_SSLCTX       = 1u << 1, // SSL_CTX_set_verify (CURLOPT_SSL_CTX_FUNCTION pinning)
+    NATIVE_CAP_VERIFY_CB    = 1u << 2, // libcrypto symbols used by openssl_verify_callback
+    NATIVE_CAP_PREFLIGHT    = 1u << 3, // libssl+libcrypto symbols used by the pinning preflight
+    NATIVE_CAP_SHARE        = 1u << 4, // curl_share_* (process-wide DNS/TLS session/connection cache)
+    NATIVE_CAP_MULTI        = 1u << 5, // curl_multi_* incl. poll/wakeup (async engine)
+    NATIVE_CAP_MULTI_SOCKET = 1u << 6, // curl_multi_socket_action/assign (epoll engine backend)
+    NATIVE_CAP_PEER_PIN     = 1u << 7, // peer certificate + hashing (pin check on curl's own handshake)
+    NATIVE_CAP_SSLCTX_DATA  = 1u << 8, // SSL_CTX ex_data (per-connection pin context for the verify callback)
+    NATIVE_CAP_SESSION_STORE = 1u << 9, // SSL_SESSION (de)serialization + session/info callbacks (persistent resumption)
+    NATIVE_CAP_PREFLIGHT_RESUME = 1u << 10, // client session cache + ticket read on the preflight's shared SSL_CTX
+};
+
+struct CurlApi {
+    curl_easy_init_t easy_init;
+    curl_easy_setopt_t easy_setopt;
+    curl_easy_perform_t easy_perform;
+    curl_easy_cleanup_t easy_cleanup;
+    curl_easy_reset_t easy_reset;
+    curl_easy_pause_t easy_pause;           // optional (stream backpressure)
+    curl_slist_append_t slist_append;
+    curl_slist_free_all_t slist_free_all;
+    curl_easy_getinfo_t easy_getinfo;
+    curl_easy_strerror_t easy_strerror;     // optional
+    curl_version_info_t version_info;       // optional
+    curl_share_init_t share_init;           // optional (NATIVE_CAP_SHARE)
+    curl_share_setopt_t share_setopt;
+    curl_share_cleanup_t share_cleanup;
+    curl_multi_init_t multi_init;           // optional (NATIVE_CAP_MULTI)
+    curl_multi_setopt_t multi_setopt;
+    curl_multi_add_handle_t multi_add_handle;
+    curl_multi_remove_handle_t multi_remove_handle;
+    curl_multi_perform_t multi_perform;
+    curl_multi_poll_t multi_poll;
+    curl_multi_wakeup_t multi_wakeup;
+    curl_multi_info_read_t multi_info_read;
+    curl_multi_cleanup_t multi_cleanup;
+    curl_multi_socket_action_t multi_socket_action; // optional (NATIVE_CAP_MULTI_SOCKET)
+    curl_multi_assign_t multi_assign;
+};
+
+struct SslApi {
+    SSL_CTX_set_verify_t SSL_CTX_set_verify;
+    TLS_client_method_t TLS_client_method;
+    SSL_CTX_new_t SSL_CTX_new;
+    SSL_new_t SSL_new;
+    SSL_set_tlsext_host_name_t SSL_set_tlsext_host_name;
+    SSL_ctrl_t SSL_ctrl;                    // OpenSSL fallback for SSL_set_tlsext_host_name
+    SSL_set_fd_t SSL_set_fd;
+    SSL_connect_t SSL_connect;
+    SSL_free_t SSL_free;
+    SSL_CTX_free_t SSL_CTX_free;
+    SSL_get_peer_certificate_t SSL_get_peer_certificate; // or SSL_get1_peer_certificate (OpenSSL 3)
+    SSL_session_reused_t SSL_session_reused; // optional, used for resumption metrics
+    SSL_CTX_get_ex_new_index_t SSL_CTX_get_ex_new_index; // BoringSSL; a macro over CRYPTO_* in OpenSSL
+    SSL_CTX_set_ex_data_t SSL_CTX_set_ex_data;
+    SSL_CTX_get_ex_data_t SSL_CTX_get_ex_data;
+    SSL_get_SSL_CTX_t SSL_get_SSL_CTX;
+    SSL_get_ex_data_X509_STORE_CTX_idx_t SSL_get_ex_data_X509_STORE_CTX_idx;
+    SSL_CTX_sess_set_new_cb_t SSL_CTX_sess_set_new_cb;   // NATIVE_CAP_SESSION_STORE
+    SSL_CTX_sess_get_new_cb_t SSL_CTX_sess_get_new_cb;
+    SSL_CTX_set_info_callback_t SSL_CTX_set_info_callback;
+    SSL_CTX_get_info_callback_t SSL_CTX_get_info_callback;
+    SSL_set_session_t SSL_set_session;
+    SSL_get_session_t SSL_get_session;
+    SSL_SESSION_free_t SSL_SESSION_free;
+    i2d_SSL_SESSION_t i2d_SSL_SESSION;
+    d2i_SSL_SESSION_t d2i_SSL_SESSION;
+    SSL_SESSION_get_time_t SSL_SESSION_get_time;
+    SSL_SESSION_get_timeout_t SSL_SESSION_get_timeout;
+    SSL_SESSION_is_resumable_t SSL_SESSION_is_resumable; // optional (OpenSSL 1.1.1+, BoringSSL)
+    SSL_CTX_load_verify_locations_t SSL_CTX_load_verify_locations; // optional, preflight CA store
+    SSL_CTX_set_alpn_protos_t SSL_CTX_set_alpn_protos;               // optional, preflight ALPN
+    SSL_CTX_ctrl_t SSL_CTX_ctrl;                                     // NATIVE_CAP_PREFLIGHT_RESUME (either
+    SSL_CTX_set_session_cache_mode_t SSL_CTX_set_session_cache_mode; // of these two)
+    SSL_peek_t SSL_peek;
+    SSL_get_error_t SSL_get_error;
+    SSL_shutdown_t SSL_shutdown;
+};
+
+struct CryptoApi {
+    X509_STORE_CTX_get_current_cert_t X509_STORE_CTX_get_current_cert;
+    X509_STORE_CTX_get_error_depth_t X509_STORE_CTX_get_error_depth;
+    X509_STORE_CTX_get_ex_data_t X509_STORE_CTX_get_ex_data;
+    CRYPTO_get_ex_new_index_t CRYPTO_get_ex_new_index; // OpenSSL fallback for SSL_CTX_get_ex_new_index
+    i2d_X509_t i2d_X509;
+    X509_get_pubkey_t X509_get_pubkey;
+    i2d_PUBKEY_t i2d_PUBKEY;
+    EVP_PKEY_free_t EVP_PKEY_free;
+    X509_free_t X509_free;
+    SHA256_fn_t SHA256;
+};
+
+struct NativeApi {
+    uint32_t caps;
+    CurlApi curl;
+    SslApi ssl;
+    CryptoApi crypto;
+    const char* curl_version;       // "unknown" if curl_version_info is missing
+    const char* ssl_version;        // "none" if curl reports no TLS backend
+    char curl_load_error[256];      // dlerror() text when libcurl.so failed to load
+
+    bool has(uint32_t cap) const { return (caps & cap) == cap; }
+};
+
+// Returns the process-wide table, resolving it on first call (thread-safe).
+const NativeApi& native_api();
+
+// New SSL_CTX ex_data slot whose values are released with freeFn when the SSL_CTX is
+// freed (SSL_CTX_get_ex_new_index on BoringSSL, CRYPTO_get_ex_new_index on OpenSSL).
+// -1 without NATIVE_CAP_SSLCTX_DATA or when the TLS library refuses.
+int native_ssl_ctx_ex_new_index(CRYPTO_EX_free_t freeFn);
+
+// SNI for a client SSL (SSL_set_tlsext_host_name, or SSL_ctrl on OpenSSL)
+bool native_ssl_set_host_name(void* ssl, const char* host);
+
+// SSL_CTX_set_session_cache_mode (a function in BoringSSL, an SSL_CTX_ctrl macro in
+// OpenSSL). False without NATIVE_CAP_PREFLIGHT_RESUME.
+bool native_ssl_ctx_set_session_cache_mode(void* ctx, int mode);
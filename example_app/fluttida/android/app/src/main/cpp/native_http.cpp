@@ -2,9 +2,13 @@
 #include <string>
 #include <sstream>
 #include <vector>
-#include <android/log.h>
-#include <dlfcn.h>
 #include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <unordered_map>
 #include <cstring>
 #include <sys/types.h>
 #include <sys/socket.h>
@@ -12,6 +16,8 @@
 #include <unistd.h>
 #include <arpa/inet.h>
 #include <netinet/in.h>
+#include <sys/stat.h>
+#include <sys/time.h>
 #include <cstdio>
 #include <cstdlib>
 #include <cctype>
@@ -20,806 +26,1663 @@
 // Include curl.h for proper CURLOPT constants
 #include <curl/curl.h>
 
-#define LOG_TAG "FluttidaNativeHttp"
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+#include "body_buffer.h"
+#include "curl_engine.h"
+#include "curl_share.h"
+#include "dns_cache.h"
+#include "easy_pool.h"
+#include "happy_eyeballs.h"
+#include "header_arena.h"
+#include "json_escape.h"
+#include "log_ring.h"
+#include "native_api.h"
+#include "native_log.h"
+#include "pin_cache.h"
+#include "pin_context.h"
+#include "pin_matcher.h"
+#include "pin_verify.h"
+#include "preflight_ctx.h"
+#include "session_store.h"
 
 // Global JNI references for logging to Flutter UI
 static JavaVM* g_jvm = nullptr;
 static jclass g_mainActivityClass = nullptr;
-static jmethodID g_sendLogMethod = nullptr;
+static jmethodID g_sendLogBatchMethod = nullptr;
+static jmethodID g_verifyHostPinsMethod = nullptr;
+static jmethodID g_callbackOnCompleteMethod = nullptr;
+static jmethodID g_bodyCallbackOnBodyMethod = nullptr;
+static jmethodID g_streamOnChunkMethod = nullptr;
+static jmethodID g_streamOnCompleteMethod = nullptr;
+// Request body classes recognised by read_request_body
+static jclass g_stringClass = nullptr;
+static jclass g_byteArrayClass = nullptr;
+static jclass g_byteBufferClass = nullptr;
+static jclass g_fileClass = nullptr;
+static jmethodID g_fileGetPathMethod = nullptr;
+static jmethodID g_bufferPositionMethod = nullptr;
+static jmethodID g_bufferLimitMethod = nullptr;
+// NativeHttp.Request descriptor fields read by nativeHttpBatch
+static jfieldID g_reqMethodField = nullptr;
+static jfieldID g_reqUrlField = nullptr;
+static jfieldID g_reqHeadersField = nullptr;
+static jfieldID g_reqBodyField = nullptr;
+static jfieldID g_reqTimeoutField = nullptr;
+static jfieldID g_reqHeaderPairsField = nullptr;
+static jfieldID g_reqOptionsField = nullptr;
+static jfieldID g_reqResponseHeadersField = nullptr;
+// NativeHttp.Options fields (typed replacement for the X-Curl-* pseudo headers)
+static jfieldID g_optInsecureField = nullptr;
+static jfieldID g_optCaInfoField = nullptr;
+static jfieldID g_optSpkiPinsField = nullptr;
+static jfieldID g_optCertPinsField = nullptr;
+static jfieldID g_optTechniqueField = nullptr;
+static jfieldID g_optHttp2Field = nullptr;
+// java.util.Map walk for the legacy Map<String,String> header entry points
+static jmethodID g_mapEntrySetMethod = nullptr;
+static jmethodID g_setIteratorMethod = nullptr;
+static jmethodID g_iterHasNextMethod = nullptr;
+static jmethodID g_iterNextMethod = nullptr;
+static jmethodID g_entryGetKeyMethod = nullptr;
+static jmethodID g_entryGetValueMethod = nullptr;
+// NativeHttp.Result: allocated with its no-arg constructor, then filled field by field
+static jclass g_resultClass = nullptr;
+static jmethodID g_resultCtor = nullptr;
+static jfieldID g_resultStatusField = nullptr;
+static jfieldID g_resultBodyField = nullptr;
+static jfieldID g_resultDurationField = nullptr;
+static jfieldID g_resultErrorCodeField = nullptr;
+static jfieldID g_resultErrorField = nullptr;
+static jfieldID g_resultHttpVersionField = nullptr;
+static jfieldID g_resultHeadersField = nullptr;
+static jfieldID g_resultTimingField = nullptr;
+// Global jstrings for the interned header names (header_common_name order)
+static jstring* g_headerNameRefs = nullptr;
 
-// Globals for CURLOPT_SSL_CTX_FUNCTION verify callback
-static std::string g_spkiPinsCsv_global;
-static std::string g_certPinsCsv_global;
+// write callback for libcurl: append received bytes into std::string
+static size_t write_cb_fn(void* ptr, size_t size, size_t nmemb, void* userdata) {
+    size_t total = size * nmemb;
+    if (userdata) {
+        try { ((std::string*)userdata)->append((char*)ptr, total); } catch (...) {}
+    }
+    return total;
+}
 
-// Helper to send log messages to Flutter UI
-static void sendLogToFlutter(const char* msg) {
-    if (!g_jvm || !g_sendLogMethod) return;
-    JNIEnv* env = nullptr;
-    bool detach = false;
-    int status = g_jvm->GetEnv((void**)&env, JNI_VERSION_1_6);
-    if (status == JNI_EDETACHED) {
-        if (g_jvm->AttachCurrentThread(&env, nullptr) != 0) return;
-        detach = true;
-    }
-    if (env && g_sendLogMethod) {
-        jstring jmsg = env->NewStringUTF(msg);
-        if (jmsg) {
-            env->CallStaticVoidMethod(g_mainActivityClass, g_sendLogMethod, jmsg);
-            env->DeleteLocalRef(jmsg);
-        }
-    }
-    if (detach) g_jvm->DetachCurrentThread();
-}
-
-// Minimal base64 encoder for 32-byte input
-static std::string base64_encode_32(const unsigned char in[32]) {
-    static const char b64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-    char out[48];
-    int outlen = 0;
-    unsigned int val = 0;
-    int valb = -6;
-    for (int i = 0; i < 32; ++i) {
-        val = (val << 8) + in[i];
-        valb += 8;
-        while (valb >= 0) {
-            out[outlen++] = b64[(val >> valb) & 0x3F];
-            valb -= 6;
-        }
-    }
-    if (valb > -6) out[outlen++] = b64[((val << 8) >> (valb + 8)) & 0x3F];
-    while (outlen % 4) out[outlen++] = '=';
-    return std::string(out, outlen);
-}
-
-// Forward declarations for dlsym-resolved OpenSSL functions we will call from verify callback
-typedef unsigned char* (*SHA256_fn_t)(const unsigned char*, size_t, unsigned char*);
-typedef int (*i2d_X509_t)(void*, unsigned char**);
-typedef int (*i2d_PUBKEY_t)(void*, unsigned char**);
-typedef void* (*X509_get_pubkey_t)(void*);
-typedef void (*EVP_PKEY_free_t)(void*);
-typedef void (*X509_free_t)(void*);
-typedef void* (*X509_STORE_CTX_get_current_cert_t)(void*);
-typedef int (*X509_STORE_CTX_get_error_depth_t)(void*);
-
-// Helper: detect if SSL_CTX_set_verify is available in libssl
-static bool sslctx_available() {
-    void* libssl = dlopen("libssl.so", RTLD_LAZY);
-    if (!libssl) return false;
-    void* sym = dlsym(libssl, "SSL_CTX_set_verify");
-    dlclose(libssl);
-    return sym != nullptr;
-}
-
-// The actual verify callback called by OpenSSL during chain verification
-static int openssl_verify_callback(int preverify_ok, void* x509_ctx) {
-    LOGI("=== openssl_verify_callback called, preverify_ok=%d ===", preverify_ok);
-    
-    // Resolve needed symbols from libcrypto at runtime
-    void* libcrypto = dlopen("libcrypto.so", RTLD_LAZY);
-    if (!libcrypto) {
-        LOGE("openssl_verify_callback: failed to dlopen libcrypto.so");
-        return 0; // fail closed
-    }
-
-    X509_STORE_CTX_get_current_cert_t fp_get_current = (X509_STORE_CTX_get_current_cert_t)dlsym(libcrypto, "X509_STORE_CTX_get_current_cert");
-    X509_STORE_CTX_get_error_depth_t fp_get_depth = (X509_STORE_CTX_get_error_depth_t)dlsym(libcrypto, "X509_STORE_CTX_get_error_depth");
-    i2d_X509_t fp_i2d_X509 = (i2d_X509_t)dlsym(libcrypto, "i2d_X509");
-    X509_get_pubkey_t fp_X509_get_pubkey = (X509_get_pubkey_t)dlsym(libcrypto, "X509_get_pubkey");
-    i2d_PUBKEY_t fp_i2d_PUBKEY = (i2d_PUBKEY_t)dlsym(libcrypto, "i2d_PUBKEY");
-    EVP_PKEY_free_t fp_EVP_PKEY_free = (EVP_PKEY_free_t)dlsym(libcrypto, "EVP_PKEY_free");
-    X509_free_t fp_X509_free = (X509_free_t)dlsym(libcrypto, "X509_free");
-    SHA256_fn_t fp_SHA256 = (SHA256_fn_t)dlsym(libcrypto, "SHA256");
-
-    if (!fp_get_current || !fp_get_depth || !fp_i2d_X509 || !fp_X509_get_pubkey || !fp_i2d_PUBKEY || !fp_EVP_PKEY_free || !fp_X509_free || !fp_SHA256) {
-        LOGE("openssl_verify_callback: failed to resolve OpenSSL symbols");
-        dlclose(libcrypto);
-        return 0;
+static JNIEnv* attached_env();
+
+// Where a request body comes from. Text stays on CURLOPT_POSTFIELDS; the others are
+// streamed through CURLOPT_READFUNCTION so curl never needs its own copy.
+enum class BodyKind {
+    None,
+    Text,       // java.lang.String (copied as UTF-8)
+    Bytes,      // byte[] (copied once, NUL-safe)
+    Direct,     // direct java.nio.ByteBuffer (read in place; the buffer is kept alive by bodyRef)
+    File,       // java.io.File (read from disk, constant memory)
+    Invalid,    // anything else: fails the request in setup_transfer
+};
+
+// Global ref that is dropped from whichever thread ends the transfer
+struct JavaGlobalRef {
+    jobject ref = nullptr;
+    JavaGlobalRef() = default;
+    JavaGlobalRef(const JavaGlobalRef&) = delete;
+    JavaGlobalRef& operator=(const JavaGlobalRef&) = delete;
+    ~JavaGlobalRef() {
+        if (!ref) return;
+        if (JNIEnv* env = attached_env()) env->DeleteGlobalRef(ref);
     }
+};
+
+// Parsed request parameters shared by the blocking and async entry points
+struct RequestSpec {
+    std::string method = "GET";
+    std::string url;
+    std::vector<std::string> headers; // "Key: Value"
+    BodyKind bodyKind = BodyKind::None;
+    std::string body;           // Text and Bytes
+    const char* directData = nullptr;
+    size_t directLen = 0;
+    JavaGlobalRef bodyRef;      // Direct
+    std::string bodyFile;       // File
+    int timeoutMs = 0;
+    bool insecure = false;      // allow overriding TLS verification via pseudo header: X-Curl-Insecure:true
+    std::string caInfoPath;     // allow overriding CA bundle path via X-Curl-CaInfo: /path/to/cacert.pem
+    std::string spkiPinsCsv;    // optional pseudo-header X-Curl-SpkiPins: comma-separated base64 pins
+    std::string certPinsCsv;    // optional pseudo-header X-Curl-CertPins: comma-separated base64 pins
+    std::string curlTechnique;  // optional pseudo-header X-Curl-Technique: preflight|sslctx|both|handshake
+    bool http2 = false;         // pseudo-header X-Curl-Http2:true negotiates h2 via ALPN and multiplexes
+    std::vector<std::string> responseHeaders; // header names to hand back ("*" = all, empty = none)
+    std::shared_ptr<const PinMatcher> pins; // compiled from the CSVs in setup_transfer
+
+    bool hasPins() const { return !spkiPinsCsv.empty() || !certPinsCsv.empty(); }
+};
 
-    // Only verify the leaf certificate (depth 0); allow intermediates/roots to pass
-    int depth = fp_get_depth(x509_ctx);
-    LOGI("openssl_verify_callback: cert depth=%d", depth);
-    if (depth != 0) {
-        LOGI("openssl_verify_callback: accepting intermediate/root cert at depth %d", depth);
-        dlclose(libcrypto);
-        return 1; // Accept intermediate/root certs
+// CURLOPT_READFUNCTION state for Bytes/Direct/File bodies
+struct BodyReader {
+    const char* data = nullptr; // memory source
+    size_t len = 0;
+    size_t off = 0;
+    FILE* fp = nullptr;         // file source
+};
+
+static size_t body_read_cb(char* buffer, size_t size, size_t nitems, void* userdata) {
+    auto* r = (BodyReader*)userdata;
+    size_t room = size * nitems;
+    if (r->fp) {
+        size_t n = fread(buffer, 1, room, r->fp);
+        if (n == 0 && ferror(r->fp)) return CURL_READFUNC_ABORT;
+        return n;
     }
+    size_t n = r->len - r->off < room ? r->len - r->off : room;
+    memcpy(buffer, r->data + r->off, n);
+    r->off += n;
+    return n;
+}
 
-    LOGI("openssl_verify_callback: checking LEAF cert (depth 0)");
-    LOGI("openssl_verify_callback: g_spkiPinsCsv='%s', g_certPinsCsv='%s'", 
-         g_spkiPinsCsv_global.c_str(), g_certPinsCsv_global.c_str());
+// Lets curl rewind the body (redirects, auth retries, HTTP/2 stream resets)
+static int body_seek_cb(void* userdata, curl_off_t offset, int origin) {
+    auto* r = (BodyReader*)userdata;
+    if (origin != SEEK_SET || offset < 0) return CURL_SEEKFUNC_CANTSEEK;
+    if (r->fp) return fseeko(r->fp, (off_t)offset, SEEK_SET) == 0 ? CURL_SEEKFUNC_OK : CURL_SEEKFUNC_FAIL;
+    if ((size_t)offset > r->len) return CURL_SEEKFUNC_FAIL;
+    r->off = (size_t)offset;
+    return CURL_SEEKFUNC_OK;
+}
 
-    void* cert = fp_get_current(x509_ctx);
-    if (!cert) { 
-        LOGE("openssl_verify_callback: failed to get current cert");
-        dlclose(libcrypto); 
-        return 0; 
+// One transfer: the pooled easy handle plus everything curl holds pointers into
+struct Transfer {
+    RequestSpec spec;
+    std::chrono::steady_clock::time_point start;
+    std::string poolKey;
+    void* curl = nullptr;
+    BodyReader reader;
+    HeaderArena headers;
+    int64_t preflightUs = 0;
+    void* header_list = nullptr;
+    void* resolve_list = nullptr;   // CURLOPT_RESOLVE entry from the native DNS cache
+    std::string resp;
+    ShareProbe shareProbe;
+    bool want_preflight = false;
+    bool pinRejected = false;   // handshake technique: curl's negotiated leaf failed the pins
+    bool sslctxPins = false;    // sslctx technique: pins checked in pin_verify_callback
+    bool binaryBody = false;    // write into body (nativeSubmitBody) instead of resp
+    BodyBuffer body;
+    struct StreamState* stream = nullptr; // nativeStreamSubmit: chunks go to Java as they arrive
+};
+
+// Callback set via CURLOPT_SSL_CTX_FUNCTION; receives curl's per-connection SSL_CTX* and the
+// Transfer (CURLOPT_SSL_CTX_DATA) as userptr. Installs the pin verify callback (sslctx
+// technique) and the persistent session store hooks.
+static int ssl_ctx_callback_stub(void* /*curl*/, void* ssl_ctx, void* userptr) {
+    LOGV("=== ssl_ctx_callback_stub called ===");
+    auto* t = static_cast<Transfer*>(userptr);
+    if (!t) return 0;
+    if (t->sslctxPins) {
+        int rc = pin_verify_install(ssl_ctx, t->spec.pins);
+        if (rc != 0) return rc;
+    }
+    // sessions are keyed like pooled handles: same origin, trust settings and pins
+    if (session_store_enabled() && !session_store_attach(ssl_ctx, t->poolKey)) {
+        LOGD("ssl_ctx_callback_stub: session store not attached");
     }
+    return 0; // success
+}
 
-    unsigned char* certbuf = nullptr;
-    int certlen = fp_i2d_X509(cert, &certbuf);
-    bool ok = false;
-    if (certlen > 0 && certbuf) {
-        unsigned char digest[32];
-        fp_SHA256(certbuf, certlen, digest);
-        std::string certB64 = base64_encode_32(digest);
-        LOGI("openssl_verify_callback: computed cert hash: %s", certB64.c_str());
-        std::string logMsg = "[NativeCurl/SSL_CTX] Server Cert SHA256: " + certB64;
-        sendLogToFlutter(logMsg.c_str());
-        // compare to CSV
-        if (!g_certPinsCsv_global.empty()) {
-            LOGI("openssl_verify_callback: checking against cert pins...");
-            std::istringstream iss(g_certPinsCsv_global);
-            std::string tok;
-            while (std::getline(iss, tok, ',')) {
-                size_t p = tok.find("sha256/");
-                std::string np = (p==std::string::npos) ? tok : tok.substr(p+7);
-                // trim
-                while (!np.empty() && isspace((unsigned char)np.front())) np.erase(np.begin());
-                while (!np.empty() && isspace((unsigned char)np.back())) np.pop_back();
-                LOGI("openssl_verify_callback: comparing cert hash '%s' vs pin '%s'", certB64.c_str(), np.c_str());
-                std::string cmpMsg = "[PIN DEBUG] Comparing against configured pin: " + np;
-                sendLogToFlutter(cmpMsg.c_str());
-                if (np == certB64) { 
-                    LOGI("openssl_verify_callback: CERT HASH MATCH!");
-                    sendLogToFlutter("[PIN DEBUG] ✓ Pin matched");
-                    ok = true; 
-                    break; 
-                }
-            }
-            if (!ok) {
-                LOGI("openssl_verify_callback: no cert hash match found");
-                sendLogToFlutter("[PIN DEBUG] ✗ No matching cert hash pin found");
-            }
+static int elapsed_ms(const std::chrono::steady_clock::time_point& start) {
+    return (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Per-phase breakdown of one request. The curl times are CURLINFO_*_TIME_T values:
+// microseconds from the start of the transfer, so each one includes the phases before it.
+struct TransferTiming {
+    int64_t nameLookupUs = 0;
+    int64_t connectUs = 0;
+    int64_t appConnectUs = 0;       // TLS handshake done (0 for plain http)
+    int64_t preTransferUs = 0;
+    int64_t startTransferUs = 0;    // first response byte
+    int64_t totalUs = 0;
+    int64_t pinCheckUs = 0;         // preflight pin verification, before curl starts
+    int64_t uploadBytes = 0;
+    int64_t downloadBytes = 0;
+    int64_t numConnects = 0;        // new connections this transfer had to open
+    int64_t tlsResumed = -1;        // connection's TLS handshake: 1 resumed, 0 full, -1 unknown / plain http
+};
+// Order of NativeHttp.Result.timing (LongArray); keep in sync with NativeHttp.kt
+constexpr int kTimingFields = 11;
+
+// Outcome of one request; rendered as NativeHttp.Result (or JSON for nativeHttpRequest)
+struct TransferResult {
+    long status = -1;               // HTTP status, -1 when there is no response
+    std::string body;
+    int durationMs = 0;
+    int errorCode = 0;              // CURLcode, or -1 for failures outside curl (setup, pinning)
+    std::string error;              // empty on success
+    const char* httpVersion = nullptr;
+    HeaderArena headers;            // only the names requested in RequestSpec::responseHeaders
+    TransferTiming timing;
+};
+
+static TransferResult error_result(int durationMs, const std::string& err) {
+    TransferResult r;
+    r.durationMs = durationMs;
+    r.errorCode = -1;
+    r.error = err;
+    return r;
+}
+
+// Legacy JSON form: {"status":..,"body":"..","durationMs":..,"httpVersion":"..","error":..}.
+// The escaper keeps the output valid modified UTF-8 for NewStringUTF whatever the body bytes are.
+static std::string result_json(const TransferResult& r) {
+    std::string out;
+    if (r.error.empty()) {
+        out.reserve(r.body.size() + r.body.size() / 8 + 128);
+        out += "{\"status\":";
+        out += std::to_string(r.status);
+        out += ",\"body\":\"";
+        json_escape_append(out, r.body.data(), r.body.size());
+        out += "\",\"durationMs\":";
+        out += std::to_string(r.durationMs);
+        out += ",\"httpVersion\":\"";
+        out += r.httpVersion ? r.httpVersion : "unknown";
+        out += "\",\"error\":null}";
+    } else {
+        out += "{\"status\":null,\"body\":\"\",\"durationMs\":";
+        out += std::to_string(r.durationMs);
+        out += ",\"error\":\"";
+        json_escape_append(out, r.error.data(), r.error.size());
+        out += "\"}";
+    }
+    return out;
+}
+
+// Classifies the body object (String, byte[], direct ByteBuffer or File) into spec
+static void read_request_body(JNIEnv* env, jobject jbody, RequestSpec& spec) {
+    if (g_stringClass && env->IsInstanceOf(jbody, g_stringClass)) {
+        const char* body_c = env->GetStringUTFChars((jstring)jbody, nullptr);
+        if (body_c) {
+            spec.body = body_c;
+            spec.bodyKind = BodyKind::Text;
+            env->ReleaseStringUTFChars((jstring)jbody, body_c);
         }
-        free(certbuf);
-    }
-
-    if (!ok && !g_spkiPinsCsv_global.empty()) {
-        LOGI("openssl_verify_callback: checking against SPKI pins...");
-        void* pkey = fp_X509_get_pubkey(cert);
-        if (pkey) {
-            unsigned char* pkbuf = nullptr;
-            int pklen = fp_i2d_PUBKEY(pkey, &pkbuf);
-            if (pklen > 0 && pkbuf) {
-                unsigned char pdigest[32];
-                fp_SHA256(pkbuf, pklen, pdigest);
-                std::string pkB64 = base64_encode_32(pdigest);
-                LOGI("openssl_verify_callback: computed SPKI hash: %s", pkB64.c_str());
-                std::string logMsg = "[NativeCurl/SSL_CTX] Server SPKI SHA256: " + pkB64;
-                sendLogToFlutter(logMsg.c_str());
-                std::istringstream iss2(g_spkiPinsCsv_global);
-                std::string tok2;
-                while (std::getline(iss2, tok2, ',')) {
-                    size_t p = tok2.find("sha256/");
-                    std::string np = (p==std::string::npos) ? tok2 : tok2.substr(p+7);
-                    while (!np.empty() && isspace((unsigned char)np.front())) np.erase(np.begin());
-                    while (!np.empty() && isspace((unsigned char)np.back())) np.pop_back();
-                    LOGI("openssl_verify_callback: comparing SPKI hash '%s' vs pin '%s'", pkB64.c_str(), np.c_str());
-                    std::string cmpMsg = "[PIN DEBUG] Comparing against configured pin: " + np;
-                    sendLogToFlutter(cmpMsg.c_str());
-                    if (np == pkB64) { 
-                        LOGI("openssl_verify_callback: SPKI HASH MATCH!");
-                        sendLogToFlutter("[PIN DEBUG] ✓ Pin matched");
-                        ok = true; 
-                        break; 
-                    }
-                }
-                if (!ok) {
-                    LOGI("openssl_verify_callback: no SPKI hash match found");
-                    sendLogToFlutter("[PIN DEBUG] ✗ No matching SPKI pin found");
-                }
-                free(pkbuf);
+    } else if (g_byteArrayClass && env->IsInstanceOf(jbody, g_byteArrayClass)) {
+        jsize n = env->GetArrayLength((jbyteArray)jbody);
+        spec.body.resize((size_t)n);
+        if (n > 0) env->GetByteArrayRegion((jbyteArray)jbody, 0, n, (jbyte*)&spec.body[0]);
+        spec.bodyKind = BodyKind::Bytes;
+    } else if (g_byteBufferClass && env->IsInstanceOf(jbody, g_byteBufferClass)) {
+        // The remaining bytes [position, limit) are sent; heap buffers have no stable address and are rejected
+        void* addr = env->GetDirectBufferAddress(jbody);
+        jint pos = -1;
+        jint limit = -1;
+        if (addr && g_bufferPositionMethod && g_bufferLimitMethod) {
+            pos = env->CallIntMethod(jbody, g_bufferPositionMethod);
+            limit = env->CallIntMethod(jbody, g_bufferLimitMethod);
+            if (env->ExceptionCheck()) {
+                env->ExceptionClear();
+                pos = limit = -1;
             }
-            fp_EVP_PKEY_free(pkey);
+        }
+        if (addr && pos >= 0 && limit >= pos) {
+            spec.directData = (const char*)addr + pos;
+            spec.directLen = (size_t)(limit - pos);
+            spec.bodyRef.ref = env->NewGlobalRef(jbody);
+            spec.bodyKind = BodyKind::Direct;
+        } else {
+            spec.bodyKind = BodyKind::Invalid;
+        }
+    } else if (g_fileClass && env->IsInstanceOf(jbody, g_fileClass)) {
+        auto jpath = (jstring)env->CallObjectMethod(jbody, g_fileGetPathMethod);
+        const char* path_c = jpath ? env->GetStringUTFChars(jpath, nullptr) : nullptr;
+        if (path_c) {
+            spec.bodyFile = path_c;
+            spec.bodyKind = BodyKind::File;
+            env->ReleaseStringUTFChars(jpath, path_c);
+        } else {
+            env->ExceptionClear();
+            spec.bodyKind = BodyKind::Invalid;
+        }
+        if (jpath) env->DeleteLocalRef(jpath);
+    } else {
+        spec.bodyKind = BodyKind::Invalid;
+    }
+}
+
+static std::string jstring_to_std(JNIEnv* env, jstring js) {
+    std::string out;
+    if (!js) return out;
+    const char* c = env->GetStringUTFChars(js, nullptr);
+    if (c) {
+        out = c;
+        env->ReleaseStringUTFChars(js, c);
+    }
+    return out;
+}
+
+static bool truthy(const char* v) {
+    return v && (strcmp(v, "true") == 0 || strcmp(v, "1") == 0 || strcmp(v, "TRUE") == 0);
+}
+
+// Appends "Key: Value" to spec.headers without intermediate temporaries
+static void add_header(RequestSpec& spec, const char* k, const char* v) {
+    size_t kl = strlen(k), vl = strlen(v);
+    std::string line;
+    line.reserve(kl + 2 + vl);
+    line.append(k, kl).append(": ", 2).append(v, vl);
+    spec.headers.push_back(std::move(line));
+}
+
+// Fills method/url/body/timeout; false when there is no url
+static bool read_request_common(JNIEnv* env, jstring jmethod, jstring jurl, jobject jbody, jint jtimeoutMs,
+                                RequestSpec& spec) {
+    if (!jurl) return false;
+    const char* url_c = env->GetStringUTFChars(jurl, nullptr);
+    if (!url_c) return false;
+    spec.url = url_c;
+    env->ReleaseStringUTFChars(jurl, url_c);
+    if (jmethod) {
+        const char* method_c = env->GetStringUTFChars(jmethod, nullptr);
+        if (method_c) {
+            spec.method = method_c;
+            env->ReleaseStringUTFChars(jmethod, method_c);
         }
     }
+    if (jbody) read_request_body(env, jbody, spec);
+    spec.timeoutMs = jtimeoutMs;
+    return true;
+}
 
-    dlclose(libcrypto);
-    LOGI("openssl_verify_callback: returning %d (1=success, 0=fail)", ok ? 1 : 0);
-    return ok ? 1 : 0; // 1 = verification success
+// Walks a Map<String,String> (method IDs cached in JNI_OnLoad), splitting off the
+// X-Curl-* pseudo headers
+static void read_header_map(JNIEnv* env, jobject jheadersMap, RequestSpec& spec) {
+    if (!g_mapEntrySetMethod) return;
+    jobject entrySetObj = env->CallObjectMethod(jheadersMap, g_mapEntrySetMethod);
+    jobject iterObj = entrySetObj ? env->CallObjectMethod(entrySetObj, g_setIteratorMethod) : nullptr;
+    while (iterObj && env->CallBooleanMethod(iterObj, g_iterHasNextMethod)) {
+        jobject entry = env->CallObjectMethod(iterObj, g_iterNextMethod);
+        auto k = (jstring)env->CallObjectMethod(entry, g_entryGetKeyMethod);
+        auto v = (jstring)env->CallObjectMethod(entry, g_entryGetValueMethod);
+        const char* kc = k ? env->GetStringUTFChars(k, nullptr) : "";
+        const char* vc = v ? env->GetStringUTFChars(v, nullptr) : "";
+        if (kc && vc) {
+            // pseudo headers carry per-request TLS options through the Map-based entry points
+            if (strcmp(kc, "X-Curl-Insecure") == 0) spec.insecure = truthy(vc);
+            else if (strcmp(kc, "X-Curl-CaInfo") == 0) spec.caInfoPath = vc;
+            else if (strcmp(kc, "X-Curl-SpkiPins") == 0) spec.spkiPinsCsv = vc;
+            else if (strcmp(kc, "X-Curl-CertPins") == 0) spec.certPinsCsv = vc;
+            else if (strcmp(kc, "X-Curl-Technique") == 0) spec.curlTechnique = vc;
+            else if (strcmp(kc, "X-Curl-Http2") == 0) spec.http2 = truthy(vc);
+            else add_header(spec, kc, vc);
+        }
+        if (k && kc) env->ReleaseStringUTFChars(k, kc);
+        if (v && vc) env->ReleaseStringUTFChars(v, vc);
+        if (k) env->DeleteLocalRef(k);
+        if (v) env->DeleteLocalRef(v);
+        env->DeleteLocalRef(entry);
+    }
+    if (iterObj) env->DeleteLocalRef(iterObj);
+    if (entrySetObj) env->DeleteLocalRef(entrySetObj);
 }
 
-// Callback set via CURLOPT_SSL_CTX_FUNCTION; receives SSL_CTX* as second argument
-static int ssl_ctx_callback_stub(void* /*curl*/, void* ssl_ctx, void* /*userptr*/) {
-    LOGI("=== ssl_ctx_callback_stub called ===");
-    // Resolve OpenSSL function SSL_CTX_set_verify from libssl
-    void* libssl = dlopen("libssl.so", RTLD_LAZY);
-    if (!libssl) {
-        LOGI("ssl_ctx_callback_stub: failed to dlopen libssl.so: %s", dlerror());
-        return 1; // can't set, allow
+// Flat String[] of name/value pairs; taken literally (no pseudo headers)
+static void read_header_pairs(JNIEnv* env, jobjectArray jpairs, RequestSpec& spec) {
+    jsize n = env->GetArrayLength(jpairs) & ~1;
+    spec.headers.reserve(spec.headers.size() + (size_t)n / 2);
+    for (jsize i = 0; i < n; i += 2) {
+        auto k = (jstring)env->GetObjectArrayElement(jpairs, i);
+        auto v = (jstring)env->GetObjectArrayElement(jpairs, i + 1);
+        const char* kc = k ? env->GetStringUTFChars(k, nullptr) : nullptr;
+        const char* vc = v ? env->GetStringUTFChars(v, nullptr) : "";
+        if (kc && vc) add_header(spec, kc, vc);
+        if (k && kc) env->ReleaseStringUTFChars(k, kc);
+        if (v && vc) env->ReleaseStringUTFChars(v, vc);
+        if (k) env->DeleteLocalRef(k);
+        if (v) env->DeleteLocalRef(v);
     }
-    typedef void (*SSL_CTX_set_verify_t)(void*, int, int(*)(int, void*));
-    SSL_CTX_set_verify_t fp_SSL_CTX_set_verify = (SSL_CTX_set_verify_t)dlsym(libssl, "SSL_CTX_set_verify");
-    if (!fp_SSL_CTX_set_verify) { 
-        LOGI("ssl_ctx_callback_stub: failed to resolve SSL_CTX_set_verify");
-        dlclose(libssl); 
-        return 1; 
+}
+
+// String[] of pins joined into the CSV form used by the pin checks
+static std::string read_pins(JNIEnv* env, jobjectArray jpins) {
+    std::string csv;
+    if (!jpins) return csv;
+    jsize n = env->GetArrayLength(jpins);
+    for (jsize i = 0; i < n; ++i) {
+        auto pin = (jstring)env->GetObjectArrayElement(jpins, i);
+        if (!pin) continue;
+        if (!csv.empty()) csv += ',';
+        csv += jstring_to_std(env, pin);
+        env->DeleteLocalRef(pin);
     }
-    // register our verify callback with SSL_VERIFY_PEER (0x01)
-    // This replaces the default certificate verification with our callback
-    LOGI("ssl_ctx_callback_stub: registering openssl_verify_callback (overriding default verification)");
-    fp_SSL_CTX_set_verify(ssl_ctx, 0x01 /*SSL_VERIFY_PEER*/, (int(*)(int, void*))openssl_verify_callback);
-    dlclose(libssl);
-    LOGI("ssl_ctx_callback_stub: callback registered successfully");
-    return 0; // success
+    return csv;
 }
 
-// write callback for libcurl: append received bytes into std::string
-static size_t write_cb_fn(void* ptr, size_t size, size_t nmemb, void* userdata) {
+static void read_options(JNIEnv* env, jobject jopts, RequestSpec& spec) {
+    spec.insecure = env->GetBooleanField(jopts, g_optInsecureField) == JNI_TRUE;
+    spec.http2 = env->GetBooleanField(jopts, g_optHttp2Field) == JNI_TRUE;
+    auto caInfo = (jstring)env->GetObjectField(jopts, g_optCaInfoField);
+    auto technique = (jstring)env->GetObjectField(jopts, g_optTechniqueField);
+    auto spki = (jobjectArray)env->GetObjectField(jopts, g_optSpkiPinsField);
+    auto cert = (jobjectArray)env->GetObjectField(jopts, g_optCertPinsField);
+    spec.caInfoPath = jstring_to_std(env, caInfo);
+    spec.curlTechnique = jstring_to_std(env, technique);
+    spec.spkiPinsCsv = read_pins(env, spki);
+    spec.certPinsCsv = read_pins(env, cert);
+    if (caInfo) env->DeleteLocalRef(caInfo);
+    if (technique) env->DeleteLocalRef(technique);
+    if (spki) env->DeleteLocalRef(spki);
+    if (cert) env->DeleteLocalRef(cert);
+}
+
+// Copies the Java arguments into a RequestSpec, splitting off the X-Curl-* pseudo headers
+static bool read_request_spec(JNIEnv* env, jstring jmethod, jstring jurl, jobject jheadersMap,
+                              jobject jbody, jint jtimeoutMs, RequestSpec& spec) {
+    if (!read_request_common(env, jmethod, jurl, jbody, jtimeoutMs, spec)) return false;
+    if (jheadersMap) read_header_map(env, jheadersMap, spec);
+    return true;
+}
+
+// Reads a NativeHttp.Request: headerPairs/options when set, otherwise the legacy headers Map
+static bool read_request_object(JNIEnv* env, jobject jreq, RequestSpec& spec) {
+    if (!jreq || !g_reqUrlField) return false;
+    auto jmethod = (jstring)env->GetObjectField(jreq, g_reqMethodField);
+    auto jurl = (jstring)env->GetObjectField(jreq, g_reqUrlField);
+    jobject jbody = env->GetObjectField(jreq, g_reqBodyField);
+    jint timeoutMs = env->GetIntField(jreq, g_reqTimeoutField);
+    bool ok = read_request_common(env, jmethod, jurl, jbody, timeoutMs, spec);
+    if (jmethod) env->DeleteLocalRef(jmethod);
+    if (jurl) env->DeleteLocalRef(jurl);
+    if (jbody) env->DeleteLocalRef(jbody);
+    if (!ok) return false;
+
+    jobject jheaders = env->GetObjectField(jreq, g_reqHeadersField);
+    if (jheaders) {
+        read_header_map(env, jheaders, spec);
+        env->DeleteLocalRef(jheaders);
+    }
+    if (g_reqHeaderPairsField) {
+        auto jpairs = (jobjectArray)env->GetObjectField(jreq, g_reqHeaderPairsField);
+        if (jpairs) {
+            read_header_pairs(env, jpairs, spec);
+            env->DeleteLocalRef(jpairs);
+        }
+    }
+    if (g_reqResponseHeadersField) {
+        auto jnames = (jobjectArray)env->GetObjectField(jreq, g_reqResponseHeadersField);
+        if (jnames) {
+            jsize n = env->GetArrayLength(jnames);
+            for (jsize i = 0; i < n; ++i) {
+                auto name = (jstring)env->GetObjectArrayElement(jnames, i);
+                if (!name) continue;
+                spec.responseHeaders.push_back(jstring_to_std(env, name));
+                env->DeleteLocalRef(name);
+            }
+            env->DeleteLocalRef(jnames);
+        }
+    }
+    if (g_reqOptionsField) {
+        jobject jopts = env->GetObjectField(jreq, g_reqOptionsField);
+        if (jopts) {
+            read_options(env, jopts, spec);
+            env->DeleteLocalRef(jopts);
+        }
+    }
+    return true;
+}
+
+// Hands the easy handle back to the pool and frees the header list
+static void release_transfer(Transfer& t) {
+    if (t.curl) easy_pool().release(t.poolKey, t.curl);
+    if (t.header_list) native_api().curl.slist_free_all(t.header_list);
+    if (t.resolve_list) native_api().curl.slist_free_all(t.resolve_list);
+    if (t.reader.fp) fclose(t.reader.fp);
+    t.curl = nullptr;
+    t.header_list = nullptr;
+    t.resolve_list = nullptr;
+    t.reader.fp = nullptr;
+}
+
+// Streaming delivery (nativeStreamSubmit). Chunks are handed to StreamCallback.onChunk on
+// the engine loop thread as curl writes them. Backpressure: once more than `window` bytes
+// are un-acked (nativeStreamAck) the write callback returns CURL_WRITEFUNC_PAUSE, and the
+// ack that brings the backlog under the window unpauses the handle on the loop thread.
+struct StreamState {
+    uint64_t token = 0;
+    jobject callback = nullptr;     // global ref to NativeHttp.StreamCallback
+    void* curl = nullptr;
+    int64_t window = 0;
+    // Loop thread only (acks and cancels are posted to the engine loop)
+    int64_t unacked = 0;
+    bool paused = false;
+    bool cancelled = false;
+};
+
+static size_t stream_write_cb(void* ptr, size_t size, size_t nmemb, void* userdata) {
+    auto* st = (StreamState*)userdata;
     size_t total = size * nmemb;
-    if (userdata) {
-        try { ((std::string*)userdata)->append((char*)ptr, total); } catch (...) {}
+    if (st->cancelled) return 0; // aborts the transfer with CURLE_WRITE_ERROR
+    if (st->unacked >= st->window && native_api().curl.easy_pause) {
+        // curl keeps this chunk and hands it to us again after curl_easy_pause(CONT)
+        st->paused = true;
+        return CURL_WRITEFUNC_PAUSE;
+    }
+    JNIEnv* env = attached_env();
+    if (!env || !g_streamOnChunkMethod) return 0;
+    jbyteArray chunk = env->NewByteArray((jsize)total);
+    if (!chunk) {
+        env->ExceptionClear();
+        return 0;
     }
+    env->SetByteArrayRegion(chunk, 0, (jsize)total, (const jbyte*)ptr);
+    env->CallVoidMethod(st->callback, g_streamOnChunkMethod, chunk);
+    env->DeleteLocalRef(chunk);
+    if (env->ExceptionCheck()) {
+        LOGE("stream_write_cb: onChunk threw, aborting stream %llu", (unsigned long long)st->token);
+        env->ExceptionClear();
+        return 0;
+    }
+    st->unacked += (int64_t)total;
     return total;
 }
 
-extern "C" JNIEXPORT jstring JNICALL
-Java_com_example_fluttida_NativeHttp_nativeHttpRequest(
-        JNIEnv *env,
-        jobject /* this */,
-        jstring jmethod,
-        jstring jurl,
-        jobject jheadersMap,
-        jstring jbody,
-        jint jtimeoutMs) {
-    auto start = std::chrono::steady_clock::now();
-
-    const char* method_c = jmethod ? env->GetStringUTFChars(jmethod, nullptr) : "GET";
-    const char* url_c = jurl ? env->GetStringUTFChars(jurl, nullptr) : nullptr;
-    const char* body_c = jbody ? env->GetStringUTFChars(jbody, nullptr) : nullptr;
-
-    if (!url_c) {
-        std::string err = R"({"status":null,"body":"","durationMs":0,"error":"no url"})";
-        return env->NewStringUTF(err.c_str());
-    }
-
-    // Convert headers Map<String,String> to vector of strings "Key: Value"
-    std::vector<std::string> headers;
-    bool insecure = false; // allow overriding TLS verification via pseudo header: X-Curl-Insecure:true
-    std::string caInfoPath; // allow overriding CA bundle path via X-Curl-CaInfo: /path/to/cacert.pem
-    std::string spkiPinsCsv; // optional pseudo-header X-Curl-SpkiPins: comma-separated base64 pins
-    std::string certPinsCsv; // optional pseudo-header X-Curl-CertPins: comma-separated base64 pins
-    std::string curlTechnique; // optional pseudo-header X-Curl-Technique: preflight|sslctx|both
-    if (jheadersMap) {
-        jclass mapCls = env->GetObjectClass(jheadersMap);
-        jmethodID entrySetMid = env->GetMethodID(mapCls, "entrySet", "()Ljava/util/Set;");
-        jobject entrySetObj = env->CallObjectMethod(jheadersMap, entrySetMid);
-        jclass setCls = env->FindClass("java/util/Set");
-        jmethodID iteratorMid = env->GetMethodID(setCls, "iterator", "()Ljava/util/Iterator;");
-        jobject iterObj = env->CallObjectMethod(entrySetObj, iteratorMid);
-        jclass iterCls = env->FindClass("java/util/Iterator");
-        jmethodID hasNextMid = env->GetMethodID(iterCls, "hasNext", "()Z");
-        jmethodID nextMid = env->GetMethodID(iterCls, "next", "()Ljava/lang/Object;");
-        jclass entryCls = env->FindClass("java/util/Map$Entry");
-        jmethodID getKeyMid = env->GetMethodID(entryCls, "getKey", "()Ljava/lang/Object;");
-        jmethodID getValMid = env->GetMethodID(entryCls, "getValue", "()Ljava/lang/Object;");
-        jclass strCls = env->FindClass("java/lang/String");
-        while (env->CallBooleanMethod(iterObj, hasNextMid)) {
-            jobject entry = env->CallObjectMethod(iterObj, nextMid);
-            jstring k = (jstring)env->CallObjectMethod(entry, getKeyMid);
-            jstring v = (jstring)env->CallObjectMethod(entry, getValMid);
-            const char* kc = k ? env->GetStringUTFChars(k, nullptr) : "";
-            const char* vc = v ? env->GetStringUTFChars(v, nullptr) : "";
-            // special pseudo header to control TLS verification without changing JNI signature
-            if (kc && (std::string(kc) == "X-Curl-Insecure")) {
-                insecure = (std::string(vc) == "true" || std::string(vc) == "1" || std::string(vc) == "TRUE");
-            } else if (kc && (std::string(kc) == "X-Curl-CaInfo")) {
-                caInfoPath = vc ? std::string(vc) : std::string();
-            } else if (kc && (std::string(kc) == "X-Curl-SpkiPins")) {
-                spkiPinsCsv = vc ? std::string(vc) : std::string();
-            } else if (kc && (std::string(kc) == "X-Curl-CertPins")) {
-                certPinsCsv = vc ? std::string(vc) : std::string();
-            } else if (kc && (std::string(kc) == "X-Curl-Technique")) {
-                curlTechnique = vc ? std::string(vc) : std::string();
-            } else {
-                headers.emplace_back(std::string(kc) + ": " + std::string(vc));
+// Wires the request body: POSTFIELDS for text, READFUNCTION + known size for the rest.
+// On failure releases the transfer and fills err.
+static bool setup_body(Transfer& t, TransferResult& err) {
+    const RequestSpec& spec = t.spec;
+    const CurlApi& curlApi = native_api().curl;
+    void* curl = t.curl;
+    curl_off_t size = 0;
+    switch (spec.bodyKind) {
+        case BodyKind::Text:
+            // Explicit size: curl neither copies nor strlen()s the body
+            curlApi.easy_setopt(curl, CURLOPT_POSTFIELDS, spec.body.data());
+            curlApi.easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, (curl_off_t)spec.body.size());
+            return true;
+        case BodyKind::Bytes:
+            t.reader.data = spec.body.data();
+            t.reader.len = spec.body.size();
+            break;
+        case BodyKind::Direct:
+            t.reader.data = spec.directData;
+            t.reader.len = spec.directLen;
+            break;
+        case BodyKind::File: {
+            t.reader.fp = fopen(spec.bodyFile.c_str(), "rb");
+            struct stat st{};
+            if (!t.reader.fp || fstat(fileno(t.reader.fp), &st) != 0) {
+                int e = errno;
+                release_transfer(t);
+                err = error_result(elapsed_ms(t.start), "cannot open body file " + spec.bodyFile + ": " + strerror(e));
+                return false;
             }
-            if (k) env->ReleaseStringUTFChars(k, kc);
-            if (v) env->ReleaseStringUTFChars(v, vc);
-            env->DeleteLocalRef(entry);
-        }
-        env->DeleteLocalRef(entrySetObj);
-        env->DeleteLocalRef(iterObj);
-        env->DeleteLocalRef(mapCls);
-        env->DeleteLocalRef(setCls);
-        env->DeleteLocalRef(iterCls);
-        env->DeleteLocalRef(entryCls);
-        env->DeleteLocalRef(strCls);
-    }
-
-    // Dynamically load libcurl
-    void* lib = dlopen("libcurl.so", RTLD_NOW);
-    if (!lib) {
-        auto ms = (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
-        const char* dlerr = dlerror();
-        std::string err = std::string("{\"status\":null,\"body\":\"\",\"durationMs\":") + std::to_string(ms) +
-                          ",\"error\":\"libcurl.so not found: ";
-        if (dlerr) err += dlerr;
-        err += "\"}";
-        if (jmethod) env->ReleaseStringUTFChars(jmethod, method_c);
-        if (jurl) env->ReleaseStringUTFChars(jurl, url_c);
-        if (jbody) env->ReleaseStringUTFChars(jbody, body_c);
-        return env->NewStringUTF(err.c_str());
-    }
-
-    typedef void* (*curl_easy_init_t)();
-    typedef int (*curl_easy_setopt_t)(void*, int, ...);
-    typedef int (*curl_easy_perform_t)(void*);
-    typedef void (*curl_easy_cleanup_t)(void*);
-    typedef void* (*curl_slist_append_t)(void*, const char*);
-    typedef void (*curl_slist_free_all_t)(void*);
-    typedef int (*curl_easy_getinfo_t)(void*, int, ...);
-    typedef const char* (*curl_easy_strerror_t)(int);
-    typedef void* (*curl_version_info_t)(int);
-
-    auto curl_easy_init = (curl_easy_init_t)dlsym(lib, "curl_easy_init");
-    auto curl_easy_setopt = (curl_easy_setopt_t)dlsym(lib, "curl_easy_setopt");
-    auto curl_easy_perform = (curl_easy_perform_t)dlsym(lib, "curl_easy_perform");
-    auto curl_easy_cleanup = (curl_easy_cleanup_t)dlsym(lib, "curl_easy_cleanup");
-    auto curl_slist_append = (curl_slist_append_t)dlsym(lib, "curl_slist_append");
-    auto curl_slist_free_all = (curl_slist_free_all_t)dlsym(lib, "curl_slist_free_all");
-    auto curl_easy_getinfo = (curl_easy_getinfo_t)dlsym(lib, "curl_easy_getinfo");
-    auto curl_easy_strerror = (curl_easy_strerror_t)dlsym(lib, "curl_easy_strerror");
-    auto curl_version_info = (curl_version_info_t)dlsym(lib, "curl_version_info");
-
-    if (!curl_easy_init || !curl_easy_setopt || !curl_easy_perform || !curl_easy_cleanup ||
-        !curl_slist_append || !curl_slist_free_all || !curl_easy_getinfo) {
-        auto ms = (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
-        std::string err = std::string("{\"status\":null,\"body\":\"\",\"durationMs\":") + std::to_string(ms) +
-                          ",\"error\":\"libcurl symbols missing\"}";
-        // dlclose(lib); // Keep loaded to avoid OpenSSL TLS destructor crash
-        if (jmethod) env->ReleaseStringUTFChars(jmethod, method_c);
-        if (jurl) env->ReleaseStringUTFChars(jurl, url_c);
-        if (jbody) env->ReleaseStringUTFChars(jbody, body_c);
-        return env->NewStringUTF(err.c_str());
-    }
-
-    // Check curl version and TLS backend
-    if (curl_version_info) {
-        struct curl_version_info_data {
-            int age;
-            const char* version;
-            unsigned int version_num;
-            const char* host;
-            int features;
-            const char* ssl_version;
-            long ssl_version_num;
-            const char* libz_version;
-            const char** protocols;
-        };
-        auto* ver_info = (curl_version_info_data*)curl_version_info(3); // CURLVERSION_NOW=3
-        if (ver_info) {
-            LOGI("curl version: %s, SSL backend: %s", 
-                 ver_info->version ? ver_info->version : "unknown",
-                 ver_info->ssl_version ? ver_info->ssl_version : "none");
-        }
-    }
-
-    void* curl = curl_easy_init();
+            size = (curl_off_t)st.st_size;
+            break;
+        }
+        default:
+            release_transfer(t);
+            err = error_result(elapsed_ms(t.start), "unsupported body type (use String, byte[], direct ByteBuffer or File)");
+            return false;
+    }
+    if (!t.reader.fp) size = (curl_off_t)t.reader.len;
+    t.reader.off = 0;
+    curlApi.easy_setopt(curl, CURLOPT_POST, 1L);
+    curlApi.easy_setopt(curl, CURLOPT_READFUNCTION, body_read_cb);
+    curlApi.easy_setopt(curl, CURLOPT_READDATA, &t.reader);
+    curlApi.easy_setopt(curl, CURLOPT_SEEKFUNCTION, body_seek_cb);
+    curlApi.easy_setopt(curl, CURLOPT_SEEKDATA, &t.reader);
+    curlApi.easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, size);
+    return true;
+}
+
+// ShareProbe::tlsCheck for the "handshake" technique: checks the leaf curl itself negotiated
+// (fresh, resumed or reused connection) before any request bytes go out, so pinning costs no
+// extra connection. Fails closed when there is no OpenSSL session to inspect.
+static bool handshake_pin_check(void* ssl, void* data) {
+    auto* t = (Transfer*)data;
+    auto begin = std::chrono::steady_clock::now();
+    // no SSL on plain HTTP or a non-OpenSSL backend: fails closed
+    bool ok = pin_verify_peer(ssl, *t->spec.pins, "Handshake");
+    t->preflightUs += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count();
+    if (!ok) t->pinRejected = true;
+    return ok;
+}
+
+// Borrows a pooled handle and applies every option for t.spec. On failure fills err
+// with the error result and leaves nothing allocated.
+static bool setup_transfer(Transfer& t, TransferResult& err) {
+    const RequestSpec& spec = t.spec;
+    // libcurl is resolved once into the dispatch table (see native_api.cpp)
+    const NativeApi& api = native_api();
+    if (!api.has(NATIVE_CAP_CURL)) {
+        if (api.curl.easy_init == nullptr && api.curl_load_error[0] != '\0') {
+            err = error_result(elapsed_ms(t.start), std::string("libcurl.so not found: ") + api.curl_load_error);
+        } else {
+            err = error_result(elapsed_ms(t.start), "libcurl symbols missing");
+        }
+        return false;
+    }
+    const CurlApi& curlApi = api.curl;
+
+    // Borrow a pooled handle so repeated requests to the same origin keep their connection
+    std::string trustKey = std::string(spec.insecure ? "insecure" : "verify") + "|" + spec.caInfoPath + "|" +
+                           spec.spkiPinsCsv + "|" + spec.certPinsCsv + "|" + spec.curlTechnique;
+    t.poolKey = easy_pool_key(spec.url.c_str(), trustKey);
+    void* curl = easy_pool().acquire(t.poolKey);
     if (!curl) {
-        auto ms = (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
-        std::string err = std::string("{\"status\":null,\"body\":\"\",\"durationMs\":") + std::to_string(ms) +
-                          ",\"error\":\"curl_easy_init failed\"}";
-        // dlclose(lib); // Keep loaded to avoid OpenSSL TLS destructor crash
-        if (jmethod) env->ReleaseStringUTFChars(jmethod, method_c);
-        if (jurl) env->ReleaseStringUTFChars(jurl, url_c);
-        if (jbody) env->ReleaseStringUTFChars(jbody, body_c);
-        return env->NewStringUTF(err.c_str());
+        err = error_result(elapsed_ms(t.start), "curl_easy_init failed");
+        return false;
     }
+    t.curl = curl;
 
-    std::string resp;
+    curlApi.easy_setopt(curl, CURLOPT_URL, spec.url.c_str());
+    if (t.stream) {
+        curlApi.easy_setopt(curl, CURLOPT_WRITEFUNCTION, stream_write_cb);
+        curlApi.easy_setopt(curl, CURLOPT_WRITEDATA, t.stream);
+    } else if (t.binaryBody) {
+        t.body.setCurl(curl);
+        curlApi.easy_setopt(curl, CURLOPT_WRITEFUNCTION, BodyBuffer::write);
+        curlApi.easy_setopt(curl, CURLOPT_WRITEDATA, &t.body);
+    } else {
+        curlApi.easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_cb_fn);
+        curlApi.easy_setopt(curl, CURLOPT_WRITEDATA, &t.resp);
+    }
+    if (!spec.responseHeaders.empty()) {
+        t.headers.setWanted(spec.responseHeaders);
+        curlApi.easy_setopt(curl, CURLOPT_HEADERFUNCTION, HeaderArena::write);
+        curlApi.easy_setopt(curl, CURLOPT_HEADERDATA, &t.headers);
+    }
 
-    // CURLOPT codes (from curl/curl.h); using literal ints to avoid including headers
-    const int CURLOPT_URL = 10002;
-    const int CURLOPT_WRITEFUNCTION = 20011;
-    const int CURLOPT_WRITEDATA = 10001;
-    const int CURLOPT_HTTPHEADER = 10023;
-    const int CURLOPT_POSTFIELDS = 10015;
-    const int CURLOPT_POSTFIELDSIZE = 60;
-    const int CURLOPT_CUSTOMREQUEST = 10036;
-    const int CURLOPT_CONNECTTIMEOUT_MS = 156;
-    const int CURLOPT_TIMEOUT_MS = 155;
-    const int CURLOPT_SSL_VERIFYPEER = 64;
-    const int CURLOPT_SSL_VERIFYHOST = 81;
-    const int CURLOPT_CAINFO = 10065; // string: path to CA bundle file
-
-    const int CURLINFO_RESPONSE_CODE = 2097154;
-
-    curl_easy_setopt(curl, CURLOPT_URL, url_c);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_cb_fn);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &resp);
+    // Share DNS, TLS sessions and connections with every other native request; pinned
+    // ones only with requests carrying the same pin configuration
+    bool probeAttached = curl_share_attach(curl, &t.shareProbe, spec.hasPins() ? trustKey : std::string());
 
     // method and body
-    std::string method(method_c);
-    if (method != "GET" && method != "HEAD") {
-        if (body_c) {
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body_c);
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (long)strlen(body_c));
+    if (spec.method != "GET" && spec.method != "HEAD") {
+        if (spec.bodyKind != BodyKind::None) {
+            if (!setup_body(t, err)) return false;
+            // POST mechanics for any method that carries a body; keep the verb for PUT/PATCH/...
+            if (spec.method != "POST") curlApi.easy_setopt(curl, CURLOPT_CUSTOMREQUEST, spec.method.c_str());
         } else {
             // for non-GET without body, still set custom method
-            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, method_c);
+            curlApi.easy_setopt(curl, CURLOPT_CUSTOMREQUEST, spec.method.c_str());
         }
-    } else if (method == "HEAD") {
-        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "HEAD");
+    } else if (spec.method == "HEAD") {
+        curlApi.easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "HEAD");
     }
 
     // headers
-    void* header_list = nullptr;
-    for (const auto& h : headers) {
-        header_list = curl_slist_append(header_list, h.c_str());
+    for (const auto& h : spec.headers) {
+        t.header_list = curlApi.slist_append(t.header_list, h.c_str());
+    }
+    if (t.header_list) curlApi.easy_setopt(curl, CURLOPT_HTTPHEADER, t.header_list);
+
+    // HTTP/2 over TLS (falls back to 1.1 if ALPN doesn't offer h2). PIPEWAIT makes concurrent
+    // requests to one origin wait for the first connection and multiplex onto it instead of
+    // each opening their own; only effective on the curl_multi engine paths.
+    if (spec.http2) {
+        curlApi.easy_setopt(curl, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS);
+        curlApi.easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
     }
-    if (header_list) curl_easy_setopt(curl, CURLOPT_HTTPHEADER, header_list);
 
     // timeouts
-    if (jtimeoutMs > 0) {
-        curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, (long)jtimeoutMs);
-        curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, (long)jtimeoutMs);
+    if (spec.timeoutMs > 0) {
+        curlApi.easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, (long)spec.timeoutMs);
+        curlApi.easy_setopt(curl, CURLOPT_TIMEOUT_MS, (long)spec.timeoutMs);
     }
 
+    // Pins are compiled once per distinct set and shared by whichever technique checks them
+    if (spec.hasPins()) t.spec.pins = pin_matcher_compile(spec.certPinsCsv, spec.spkiPinsCsv);
+
     // Decide technique toggles EARLY to set SSL_CTX callback before other SSL options
-    bool want_preflight = false;
     bool want_sslctx = false;
+    bool want_handshake = false;
+    const std::string& curlTechnique = spec.curlTechnique;
     if (!curlTechnique.empty()) {
-        if (curlTechnique == "preflight") want_preflight = true;
+        if (curlTechnique == "preflight") t.want_preflight = true;
         else if (curlTechnique == "sslctx") want_sslctx = true;
-        else /*both or unknown*/ { want_preflight = true; want_sslctx = true; }
+        else if (curlTechnique == "handshake") want_handshake = true;
+        else /*both or unknown*/ { t.want_preflight = true; want_sslctx = true; }
     } else {
         // default when pins present and no explicit technique: both
-        want_preflight = true; want_sslctx = true;
+        t.want_preflight = true; want_sslctx = true;
     }
+    t.want_preflight = t.want_preflight && spec.hasPins();
 
     // Log SSL_CTX availability; if sslctx-only requested but unavailable, return error
-    bool sslctxAvail = sslctx_available();
+    // (the verify callback needs ex_data to find the request's pins)
+    bool sslctxAvail = api.has(NATIVE_CAP_SSLCTX | NATIVE_CAP_SSLCTX_DATA);
     if (!curlTechnique.empty()) {
-        LOGI("SSL_CTX_set_verify available: %s (technique=%s)", sslctxAvail ? "true" : "false", curlTechnique.c_str());
+        LOGD("SSL_CTX_set_verify available: %s (technique=%s)", sslctxAvail ? "true" : "false", curlTechnique.c_str());
     } else {
-        LOGI("SSL_CTX_set_verify available: %s (technique=default)", sslctxAvail ? "true" : "false");
+        LOGD("SSL_CTX_set_verify available: %s (technique=default)", sslctxAvail ? "true" : "false");
     }
-    if ((!spkiPinsCsv.empty() || !certPinsCsv.empty()) && (curlTechnique == "sslctx") && !sslctxAvail) {
+    if (spec.hasPins() && (curlTechnique == "sslctx") && !sslctxAvail) {
         // Explicit SSL_CTX technique requested, but not supported on this build
-        if (header_list) curl_slist_free_all(header_list);
-        curl_easy_cleanup(curl);
-        int durationMs = (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
-        std::ostringstream out;
-        out << "{\"status\":null,\"body\":\"\",\"durationMs\":" << durationMs << ",\"error\":\"SSL_CTX not available in this OpenSSL build\"}";
-        if (jmethod) env->ReleaseStringUTFChars(jmethod, method_c);
-        if (jurl) env->ReleaseStringUTFChars(jurl, url_c);
-        if (jbody) env->ReleaseStringUTFChars(jbody, body_c);
-        std::string json = out.str();
-        return env->NewStringUTF(json.c_str());
+        release_transfer(t);
+        err = error_result(elapsed_ms(t.start), "SSL_CTX not available in this OpenSSL build");
+        return false;
+    }
+
+    if (spec.hasPins() && want_handshake) {
+        if (!api.has(NATIVE_CAP_PEER_PIN) || !probeAttached) {
+            release_transfer(t);
+            err = error_result(elapsed_ms(t.start), !probeAttached ? "CURLOPT_PREREQFUNCTION not supported by this libcurl"
+                                                                   : "peer certificate API not available in this OpenSSL build");
+            return false;
+        }
+        t.shareProbe.tlsCheck = handshake_pin_check;
+        t.shareProbe.tlsCheckData = &t;
     }
 
     // CRITICAL: Register SSL_CTX callback BEFORE setting other SSL options
-    if ((!spkiPinsCsv.empty() || !certPinsCsv.empty()) && want_sslctx && sslctxAvail) {
-        g_spkiPinsCsv_global = spkiPinsCsv;
-        g_certPinsCsv_global = certPinsCsv;
-        LOGI("Registering SSL_CTX callback BEFORE other SSL opts (spkiPins='%s', certPins='%s')", 
-             spkiPinsCsv.c_str(), certPinsCsv.c_str());
-        
-        int rc_func = curl_easy_setopt(curl, CURLOPT_SSL_CTX_FUNCTION, (void*)ssl_ctx_callback_stub);
-        int rc_data = curl_easy_setopt(curl, CURLOPT_SSL_CTX_DATA, nullptr);
-        LOGI("SSL_CTX callback setopt results: FUNCTION=%d, DATA=%d (0=CURLE_OK)", rc_func, rc_data);
+    // (pins for the sslctx technique; the persistent session store hooks every TLS connection)
+    t.sslctxPins = spec.hasPins() && want_sslctx && sslctxAvail;
+    bool storeSessions = spec.url.compare(0, 8, "https://") == 0 && session_store_enabled();
+    if (t.sslctxPins || storeSessions) {
+        if (t.sslctxPins) {
+            LOGV("Registering SSL_CTX callback BEFORE other SSL opts (spkiPins='%s', certPins='%s')",
+                 spec.spkiPinsCsv.c_str(), spec.certPinsCsv.c_str());
+        }
+
+        int rc_func = curlApi.easy_setopt(curl, CURLOPT_SSL_CTX_FUNCTION, (void*)ssl_ctx_callback_stub);
+        // t outlives the handshake; easy_pool resets SSL_CTX_DATA before the handle is reused
+        int rc_data = curlApi.easy_setopt(curl, CURLOPT_SSL_CTX_DATA, (void*)&t);
+        LOGD("SSL_CTX callback setopt results: FUNCTION=%d, DATA=%d (0=CURLE_OK)", rc_func, rc_data);
         if (rc_func != 0) {
             LOGE("CURLOPT_SSL_CTX_FUNCTION setopt FAILED with code %d - option not supported!", rc_func);
         }
     }
 
     // TLS verification (on by default; can be disabled via X-Curl-Insecure:true)
-    if (insecure) {
-        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
-        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
+    if (spec.insecure) {
+        curlApi.easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+        curlApi.easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
     } else {
-        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
-        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 2L);
+        curlApi.easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
+        curlApi.easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 2L);
     }
 
     // Optional CA bundle override
-    if (!caInfoPath.empty()) {
-        curl_easy_setopt(curl, CURLOPT_CAINFO, caInfoPath.c_str());
+    if (!spec.caInfoPath.empty()) {
+        curlApi.easy_setopt(curl, CURLOPT_CAINFO, spec.caInfoPath.c_str());
     }
+    return true;
+}
 
-    // If pinning pseudo-headers present and preflight desired, perform native pre-flight verification
+// Native pre-flight pin verification over a separate TLS connection.
+// env may be null on threads without a JVM; the Java fallback is then skipped.
+// Host (brackets stripped for IPv6 literals) and port of url; the port defaults by scheme
+static void parse_host_port(const std::string& urlstr, std::string& host, int& port) {
+    size_t pos = urlstr.find("://");
+    size_t start = (pos==std::string::npos) ? 0 : pos+3;
+    port = urlstr.compare(0, 7, "http://") == 0 ? 80 : 443;
+    size_t end = urlstr.find_first_of("/?#", start);
+    std::string authority = (end==std::string::npos) ? urlstr.substr(start) : urlstr.substr(start, end-start);
+    size_t at = authority.rfind('@');
+    if (at != std::string::npos) authority.erase(0, at + 1);
+    size_t colon;
+    if (!authority.empty() && authority[0] == '[') {
+        size_t close = authority.find(']');
+        host = authority.substr(1, close == std::string::npos ? std::string::npos : close - 1);
+        colon = close == std::string::npos ? std::string::npos : authority.find(':', close);
+    } else {
+        colon = authority.find(':');
+        host = authority.substr(0, colon);
+    }
+    if (colon != std::string::npos) {
+        try { port = std::stoi(authority.substr(colon+1)); } catch(...) {}
+    }
+}
+
+static bool run_preflight(JNIEnv* env, const RequestSpec& spec) {
+    const NativeApi& api = native_api();
     bool pin_ok = true;
-    if ((!spkiPinsCsv.empty() || !certPinsCsv.empty()) && want_preflight) {
-        // parse host and port
-        std::string urlstr(url_c);
-        std::string host;
-        int port = 443;
-        size_t pos = urlstr.find("://");
-        size_t start = (pos==std::string::npos) ? 0 : pos+3;
-        size_t slash = urlstr.find_first_of("/", start);
-        std::string authority = (slash==std::string::npos) ? urlstr.substr(start) : urlstr.substr(start, slash-start);
-        size_t colon = authority.find(':');
-        if (colon!=std::string::npos) {
-            host = authority.substr(0, colon);
-            try { port = std::stoi(authority.substr(colon+1)); } catch(...) { port = 443; }
+    const std::string& urlstr = spec.url;
+    std::string host;
+    int port = 443;
+    parse_host_port(urlstr, host, port);
+
+    if (urlstr.rfind("https://", 0) == 0) {
+        // OpenSSL symbols come from the dispatch table resolved at load time
+        if (!api.has(NATIVE_CAP_PREFLIGHT)) {
+            // Fallback: call Java verifier (existing method) if OpenSSL not available
+            // (cached class ref: FindClass can't see app classes from engine threads)
+            if (env && g_mainActivityClass && g_verifyHostPinsMethod) {
+                jstring jhost = env->NewStringUTF(host.c_str());
+                jstring jspki = env->NewStringUTF(spec.spkiPinsCsv.c_str());
+                jstring jcerts = env->NewStringUTF(spec.certPinsCsv.c_str());
+                jboolean res = env->CallStaticBooleanMethod(g_mainActivityClass, g_verifyHostPinsMethod, jhost, (jint)port, jspki, jcerts);
+                if (env->ExceptionCheck()) env->ExceptionClear();
+                pin_ok = (res == JNI_TRUE);
+                env->DeleteLocalRef(jhost);
+                env->DeleteLocalRef(jspki);
+                env->DeleteLocalRef(jcerts);
+            }
         } else {
-            host = authority;
-        }
-
-        if (urlstr.rfind("https://", 0) == 0) {
-            // Try to load libssl and libcrypto
-            void* libssl = dlopen("libssl.so", RTLD_LAZY);
-            void* libcrypto = dlopen("libcrypto.so", RTLD_LAZY);
-            if (!libssl || !libcrypto) {
-                // Fallback: call Java verifier (existing method) if OpenSSL not available
-                jclass cls = env->FindClass("com/example/fluttida/MainActivity");
-                if (cls) {
-                    jmethodID mid = env->GetStaticMethodID(cls, "verifyHostPins", "(Ljava/lang/String;ILjava/lang/String;Ljava/lang/String;)Z");
-                    if (mid) {
-                        jstring jhost = env->NewStringUTF(host.c_str());
-                        jstring jspki = env->NewStringUTF(spkiPinsCsv.c_str());
-                        jstring jcerts = env->NewStringUTF(certPinsCsv.c_str());
-                        jboolean res = env->CallStaticBooleanMethod(cls, mid, jhost, (jint)port, jspki, jcerts);
-                        pin_ok = (res == JNI_TRUE);
-                        env->DeleteLocalRef(jhost);
-                        env->DeleteLocalRef(jspki);
-                        env->DeleteLocalRef(jcerts);
-                    }
-                    env->DeleteLocalRef(cls);
-                }
-                if (libssl) dlclose(libssl);
-                if (libcrypto) dlclose(libcrypto);
-            } else {
-                // Resolve required OpenSSL symbols via dlsym
-                typedef const void* (*TLS_client_method_t)();
-                typedef void* (*SSL_CTX_new_t)(const void*);
-                typedef void* (*SSL_new_t)(void*);
-                typedef int (*SSL_set_tlsext_host_name_t)(void*, const char*);
-                typedef int (*SSL_set_fd_t)(void*, int);
-                typedef int (*SSL_connect_t)(void*);
-                typedef void (*SSL_free_t)(void*);
-                typedef void (*SSL_CTX_free_t)(void*);
-                typedef void* (*SSL_get_peer_certificate_t)(void*);
-                typedef void* (*X509_get_pubkey_t)(void*);
-                typedef int (*i2d_X509_t)(void*, unsigned char**);
-                typedef int (*i2d_PUBKEY_t)(void*, unsigned char**);
-                typedef void (*X509_free_t)(void*);
-                typedef void (*EVP_PKEY_free_t)(void*);
-                typedef unsigned char* (*SHA256_t)(const unsigned char*, size_t, unsigned char*);
-
-                TLS_client_method_t TLS_client_method = (TLS_client_method_t)dlsym(libssl, "TLS_client_method");
-                SSL_CTX_new_t SSL_CTX_new = (SSL_CTX_new_t)dlsym(libssl, "SSL_CTX_new");
-                SSL_new_t SSL_new = (SSL_new_t)dlsym(libssl, "SSL_new");
-                SSL_set_tlsext_host_name_t SSL_set_tlsext_host_name = (SSL_set_tlsext_host_name_t)dlsym(libssl, "SSL_set_tlsext_host_name");
-                SSL_set_fd_t SSL_set_fd = (SSL_set_fd_t)dlsym(libssl, "SSL_set_fd");
-                SSL_connect_t SSL_connect = (SSL_connect_t)dlsym(libssl, "SSL_connect");
-                SSL_free_t SSL_free = (SSL_free_t)dlsym(libssl, "SSL_free");
-                SSL_CTX_free_t SSL_CTX_free = (SSL_CTX_free_t)dlsym(libssl, "SSL_CTX_free");
-                SSL_get_peer_certificate_t SSL_get_peer_certificate = (SSL_get_peer_certificate_t)dlsym(libssl, "SSL_get_peer_certificate");
-
-                i2d_X509_t i2d_X509 = (i2d_X509_t)dlsym(libcrypto, "i2d_X509");
-                X509_get_pubkey_t X509_get_pubkey = (X509_get_pubkey_t)dlsym(libcrypto, "X509_get_pubkey");
-                i2d_PUBKEY_t i2d_PUBKEY = (i2d_PUBKEY_t)dlsym(libcrypto, "i2d_PUBKEY");
-                X509_free_t X509_free = (X509_free_t)dlsym(libcrypto, "X509_free");
-                EVP_PKEY_free_t EVP_PKEY_free = (EVP_PKEY_free_t)dlsym(libcrypto, "EVP_PKEY_free");
-                SHA256_t SHA256_fn = (SHA256_t)dlsym(libcrypto, "SHA256");
-
-                bool have_all = TLS_client_method && SSL_CTX_new && SSL_new && SSL_set_tlsext_host_name && SSL_set_fd && SSL_connect && SSL_free && SSL_CTX_free && SSL_get_peer_certificate && i2d_X509 && X509_get_pubkey && i2d_PUBKEY && X509_free && EVP_PKEY_free && SHA256_fn;
-                if (!have_all) {
-                    // Fallback to Java verifier if any symbol missing
-                    jclass cls = env->FindClass("com/example/fluttida/MainActivity");
-                    if (cls) {
-                        jmethodID mid = env->GetStaticMethodID(cls, "verifyHostPins", "(Ljava/lang/String;ILjava/lang/String;Ljava/lang/String;)Z");
-                        if (mid) {
-                            jstring jhost = env->NewStringUTF(host.c_str());
-                            jstring jspki = env->NewStringUTF(spkiPinsCsv.c_str());
-                            jstring jcerts = env->NewStringUTF(certPinsCsv.c_str());
-                            jboolean res = env->CallStaticBooleanMethod(cls, mid, jhost, (jint)port, jspki, jcerts);
-                            pin_ok = (res == JNI_TRUE);
-                            env->DeleteLocalRef(jhost);
-                            env->DeleteLocalRef(jspki);
-                            env->DeleteLocalRef(jcerts);
-                        }
-                        env->DeleteLocalRef(cls);
+            // TCP connect
+            // addresses come from the native DNS cache that also feeds curl (CURLOPT_RESOLVE);
+            // IPv6/IPv4 are raced and the whole connect is bounded by the request timeout
+            int sock = -1;
+            std::vector<DnsAddress> addrs;
+            if (dns_resolve(host, port, &addrs)) {
+                ConnectResult cr = happy_eyeballs_connect(addrs, spec.timeoutMs);
+                sock = cr.fd;
+                if (sock >= 0) {
+                    LOGD("preflight: connected to %s via %s in %lld us (%d attempts)", host.c_str(),
+                         cr.family == AF_INET6 ? "IPv6" : "IPv4", (long long)cr.elapsedUs, cr.attempts);
+                    // the handshake below is blocking: give it what is left of the deadline
+                    if (spec.timeoutMs > 0) {
+                        int64_t leftUs = (int64_t)spec.timeoutMs * 1000 - cr.elapsedUs;
+                        if (leftUs < 1000) leftUs = 1000;
+                        struct timeval tv;
+                        tv.tv_sec = (time_t)(leftUs / 1000000);
+                        tv.tv_usec = (suseconds_t)(leftUs % 1000000);
+                        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+                        setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
                     }
                 } else {
-                    // TCP connect
-                    int sock = -1;
-                    struct addrinfo hints{};
-                    struct addrinfo* res0 = nullptr;
-                    hints.ai_family = AF_UNSPEC;
-                    hints.ai_socktype = SOCK_STREAM;
-                    char portbuf[8];
-                    snprintf(portbuf, sizeof(portbuf), "%d", port);
-                    if (getaddrinfo(host.c_str(), portbuf, &hints, &res0) == 0) {
-                        for (struct addrinfo* rp = res0; rp != nullptr; rp = rp->ai_next) {
-                            sock = socket(rp->ai_family, rp->ai_socktype, rp->ai_protocol);
-                            if (sock < 0) continue;
-                            if (connect(sock, rp->ai_addr, rp->ai_addrlen) == 0) break;
-                            close(sock);
-                            sock = -1;
-                        }
-                        freeaddrinfo(res0);
-                    }
+                    LOGE("preflight: connect to %s failed (%s, errno=%d, %d attempts)", host.c_str(),
+                         cr.timedOut ? "timed out" : "refused/unreachable", cr.error, cr.attempts);
+                }
+            }
 
-                    if (sock >= 0) {
-                        // SSL handshake
-                        const void* method = TLS_client_method();
-                        void* ctx = SSL_CTX_new(method);
-                        if (ctx) {
-                            void* ssl = SSL_new(ctx);
-                            if (ssl) {
-                                SSL_set_tlsext_host_name(ssl, host.c_str());
-                                SSL_set_fd(ssl, sock);
-                                if (SSL_connect(ssl) == 1) {
-                                    void* peer = SSL_get_peer_certificate(ssl);
-                                    if (peer) {
-                                        // cert DER
-                                        unsigned char* certbuf = nullptr;
-                                        int certlen = i2d_X509(peer, &certbuf);
-                                        if (certlen > 0 && certbuf) {
-                                            unsigned char digest[32];
-                                            SHA256_fn(certbuf, certlen, digest);
-                                            // base64 encode
-                                            static const char b64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-                                            char b64out[48];
-                                            int outlen = 0;
-                                            unsigned int val = 0;
-                                            int valb = -6;
-                                            for (int i = 0; i < 32; ++i) {
-                                                val = (val << 8) + digest[i];
-                                                valb += 8;
-                                                while (valb >= 0) {
-                                                    b64out[outlen++] = b64[(val >> valb) & 0x3F];
-                                                    valb -= 6;
-                                                }
-                                            }
-                                            if (valb > -6) b64out[outlen++] = b64[((val << 8) >> (valb + 8)) & 0x3F];
-                                            while (outlen % 4) b64out[outlen++] = '=';
-                                            b64out[outlen] = '\0';
-                                            std::string certB64(b64out, outlen);
-
-                                            // compare to provided cert pins
-                                            bool match = false;
-                                            if (!certPinsCsv.empty()) {
-                                                std::istringstream iss(certPinsCsv);
-                                                std::string token;
-                                                while (std::getline(iss, token, ',')) {
-                                                    // normalize
-                                                    size_t pos = token.find("sha256/");
-                                                    std::string np = (pos==std::string::npos) ? token : token.substr(pos+7);
-                                                    // trim
-                                                    while (!np.empty() && isspace((unsigned char)np.front())) np.erase(np.begin());
-                                                    while (!np.empty() && isspace((unsigned char)np.back())) np.pop_back();
-                                                    if (np == certB64) { match = true; break; }
-                                                }
-                                            }
-
-                                            // SPKI check
-                                            if (!match && !spkiPinsCsv.empty()) {
-                                                void* pkey = X509_get_pubkey(peer);
-                                                if (pkey) {
-                                                    unsigned char* pkbuf = nullptr;
-                                                    int pklen = i2d_PUBKEY(pkey, &pkbuf);
-                                                    if (pklen > 0 && pkbuf) {
-                                                        unsigned char pdigest[32];
-                                                        SHA256_fn(pkbuf, pklen, pdigest);
-                                                        char b64pk[48];
-                                                        int outlen2 = 0;
-                                                        unsigned int val2 = 0;
-                                                        int valb2 = -6;
-                                                        for (int i = 0; i < 32; ++i) {
-                                                            val2 = (val2 << 8) + pdigest[i];
-                                                            valb2 += 8;
-                                                            while (valb2 >= 0) {
-                                                                b64pk[outlen2++] = b64[(val2 >> valb2) & 0x3F];
-                                                                valb2 -= 6;
-                                                            }
-                                                        }
-                                                        if (valb2 > -6) b64pk[outlen2++] = b64[((val2 << 8) >> (valb2 + 8)) & 0x3F];
-                                                        while (outlen2 % 4) b64pk[outlen2++] = '=';
-                                                        b64pk[outlen2] = '\0';
-                                                        std::string pkB64(b64pk, outlen2);
-                                                        std::istringstream iss2(spkiPinsCsv);
-                                                        std::string token2;
-                                                        while (std::getline(iss2, token2, ',')) {
-                                                            size_t pos = token2.find("sha256/");
-                                                            std::string np = (pos==std::string::npos) ? token2 : token2.substr(pos+7);
-                                                            while (!np.empty() && isspace((unsigned char)np.front())) np.erase(np.begin());
-                                                            while (!np.empty() && isspace((unsigned char)np.back())) np.pop_back();
-                                                            if (np == pkB64) { match = true; break; }
-                                                        }
-                                                        if (pkbuf) free(pkbuf);
-                                                    }
-                                                    EVP_PKEY_free(pkey);
-                                                }
-                                            }
-
-                                            if (!match) pin_ok = false;
-
-                                            if (certbuf) free(certbuf);
-                                        }
-                                        X509_free(peer);
-                                    }
-                                }
-                                SSL_free(ssl);
-                            }
-                            SSL_CTX_free(ctx);
-                        }
-                        close(sock);
+            if (sock >= 0) {
+                // SSL handshake on the shared per-trust-configuration context (resumes when it can)
+                PreflightTls tls;
+                if (preflight_tls_begin(tls, spec.caInfoPath, spec.insecure, host, port, sock)) {
+                    bool handshakeOk = preflight_tls_connect(tls);
+                    if (handshakeOk) {
+                        LOGD("preflight: %s handshake with %s in %lld us", tls.resumed ? "resumed" : "full",
+                             host.c_str(), (long long)tls.handshakeUs);
+                        pin_ok = pin_verify_peer(tls.ssl, *spec.pins, "Preflight");
                     }
+                    // closes the socket, possibly after a background read for a session ticket
+                    preflight_tls_end(tls, handshakeOk && pin_ok);
+                } else {
+                    close(sock);
                 }
+            }
+        }
+    }
+    return pin_ok;
+}
+
+// CURLINFO_HTTP_VERSION -> protocol label reported in the result
+static const char* http_version_name(long v) {
+    switch (v) {
+        case CURL_HTTP_VERSION_1_0: return "1.0";
+        case CURL_HTTP_VERSION_1_1: return "1.1";
+        case CURL_HTTP_VERSION_2_0: return "2";
+        case CURL_HTTP_VERSION_3: return "3";
+        default: return "unknown";
+    }
+}
+
+// Reads status, returns the handle to the pool and moves the body into the result
+// Valid after failures too (phases that never ran stay 0)
+static void read_timing(const Transfer& t, TransferTiming& out) {
+    const CurlApi& curlApi = native_api().curl;
+    curl_off_t v = 0;
+    struct { CURLINFO info; int64_t* dst; } offs[] = {
+        {CURLINFO_NAMELOOKUP_TIME_T, &out.nameLookupUs},
+        {CURLINFO_CONNECT_TIME_T, &out.connectUs},
+        {CURLINFO_APPCONNECT_TIME_T, &out.appConnectUs},
+        {CURLINFO_PRETRANSFER_TIME_T, &out.preTransferUs},
+        {CURLINFO_STARTTRANSFER_TIME_T, &out.startTransferUs},
+        {CURLINFO_TOTAL_TIME_T, &out.totalUs},
+        {CURLINFO_SIZE_UPLOAD_T, &out.uploadBytes},
+        {CURLINFO_SIZE_DOWNLOAD_T, &out.downloadBytes},
+    };
+    for (auto& o : offs) {
+        v = 0;
+        if (curlApi.easy_getinfo(t.curl, o.info, &v) == CURLE_OK) *o.dst = (int64_t)v;
+    }
+    long connects = 0;
+    if (curlApi.easy_getinfo(t.curl, CURLINFO_NUM_CONNECTS, &connects) == CURLE_OK) out.numConnects = connects;
+    out.pinCheckUs = t.preflightUs;
+    out.tlsResumed = t.shareProbe.tlsResumed;
+}
+
+static TransferResult finish_transfer(Transfer& t, int rc) {
+    const CurlApi& curlApi = native_api().curl;
+    TransferResult r;
+    if (rc == 0) {
+        curlApi.easy_getinfo(t.curl, CURLINFO_RESPONSE_CODE, &r.status);
+        long httpVersion = 0;
+        curlApi.easy_getinfo(t.curl, CURLINFO_HTTP_VERSION, &httpVersion);
+        r.httpVersion = http_version_name(httpVersion);
+        r.body = std::move(t.resp);
+        r.headers = std::move(t.headers);
+    } else if (t.pinRejected) {
+        r.errorCode = rc;
+        r.error = "SSL pinning mismatch";
+    } else {
+        r.errorCode = rc;
+        r.error = "curl_easy_perform rc=" + std::to_string(rc);
+        if (curlApi.easy_strerror) {
+            const char* es = curlApi.easy_strerror(rc);
+            if (es) r.error += std::string(" (") + es + ")";
+        }
+    }
+    read_timing(t, r.timing);
+    curl_share_record(t.curl, &t.shareProbe);
+    release_transfer(t);
+    r.durationMs = elapsed_ms(t.start);
+    return r;
+}
 
-                if (libssl) dlclose(libssl);
-                if (libcrypto) dlclose(libcrypto);
+// Header value as a Java String. HTTP field values are ISO-8859-1, which NewStringUTF
+// (modified UTF-8) would reject for bytes >= 0x80, so those go through NewString.
+static jstring new_header_value(JNIEnv* env, const char* v, size_t n) {
+    size_t i = 0;
+    while (i < n && (unsigned char)v[i] < 0x80) ++i;
+    if (i == n) return env->NewStringUTF(v);
+    std::vector<jchar> wide(n);
+    for (size_t k = 0; k < n; ++k) wide[k] = (unsigned char)v[k];
+    return env->NewString(wide.data(), (jsize)n);
+}
+
+// Flat [name, value, ...] String[]; interned names reuse the jstrings cached in JNI_OnLoad
+static jobjectArray new_header_pairs(JNIEnv* env, const HeaderArena& headers) {
+    jobjectArray pairs = env->NewObjectArray((jsize)(headers.size() * 2), g_stringClass, nullptr);
+    if (!pairs) return nullptr;
+    for (size_t i = 0; i < headers.size(); ++i) {
+        const HeaderArena::Field& f = headers.at(i);
+        jstring name = (f.interned != kHeaderNotInterned && g_headerNameRefs) ? g_headerNameRefs[f.interned] : nullptr;
+        bool ownName = !name;
+        if (ownName) name = env->NewStringUTF(headers.name(f));
+        jstring value = new_header_value(env, headers.value(f), f.valueLen);
+        env->SetObjectArrayElement(pairs, (jsize)(i * 2), name);
+        env->SetObjectArrayElement(pairs, (jsize)(i * 2 + 1), value);
+        if (ownName && name) env->DeleteLocalRef(name);
+        if (value) env->DeleteLocalRef(value);
+    }
+    return pairs;
+}
+
+// Builds a NativeHttp.Result from the cached class/constructor/field IDs
+static jobject new_jresult(JNIEnv* env, const TransferResult& r) {
+    if (!g_resultClass) return nullptr;
+    jobject obj = env->NewObject(g_resultClass, g_resultCtor);
+    if (!obj) return nullptr;
+    env->SetIntField(obj, g_resultStatusField, (jint)r.status);
+    env->SetIntField(obj, g_resultDurationField, (jint)r.durationMs);
+    env->SetIntField(obj, g_resultErrorCodeField, (jint)r.errorCode);
+    jbyteArray body = env->NewByteArray((jsize)r.body.size());
+    if (body) {
+        if (!r.body.empty()) env->SetByteArrayRegion(body, 0, (jsize)r.body.size(), (const jbyte*)r.body.data());
+        env->SetObjectField(obj, g_resultBodyField, body);
+        env->DeleteLocalRef(body);
+    }
+    if (!r.error.empty()) {
+        jstring err = env->NewStringUTF(r.error.c_str());
+        env->SetObjectField(obj, g_resultErrorField, err);
+        if (err) env->DeleteLocalRef(err);
+    }
+    if (r.httpVersion) {
+        jstring ver = env->NewStringUTF(r.httpVersion);
+        env->SetObjectField(obj, g_resultHttpVersionField, ver);
+        if (ver) env->DeleteLocalRef(ver);
+    }
+    if (g_resultTimingField) {
+        const TransferTiming& tm = r.timing;
+        jlong values[kTimingFields] = {tm.nameLookupUs, tm.connectUs, tm.appConnectUs, tm.preTransferUs,
+                                       tm.startTransferUs, tm.totalUs, tm.pinCheckUs, tm.uploadBytes,
+                                       tm.downloadBytes, tm.numConnects, tm.tlsResumed};
+        jlongArray timing = env->NewLongArray(kTimingFields);
+        if (timing) {
+            env->SetLongArrayRegion(timing, 0, kTimingFields, values);
+            env->SetObjectField(obj, g_resultTimingField, timing);
+            env->DeleteLocalRef(timing);
+        }
+    }
+    if (r.headers.size() > 0 && g_resultHeadersField) {
+        jobjectArray pairs = new_header_pairs(env, r.headers);
+        env->SetObjectField(obj, g_resultHeadersField, pairs);
+        if (pairs) env->DeleteLocalRef(pairs);
+    }
+    return obj;
+}
+
+// Returns a JNIEnv for the calling thread, attaching engine threads once for their lifetime
+static JNIEnv* attached_env() {
+    if (!g_jvm) return nullptr;
+    JNIEnv* env = nullptr;
+    if (g_jvm->GetEnv((void**)&env, JNI_VERSION_1_6) == JNI_OK) return env;
+    if (g_jvm->AttachCurrentThreadAsDaemon(&env, nullptr) != JNI_OK) return nullptr;
+    return env;
+}
+
+// log_ring sink on the drainer thread: one String[] and one static call per batch
+static void flutter_log_sink(const char* const* lines, size_t count, uint64_t dropped, void* /*ctx*/) {
+    JNIEnv* env = attached_env();
+    if (!env || !g_mainActivityClass || !g_sendLogBatchMethod || !g_stringClass) return;
+    jobjectArray arr = env->NewObjectArray((jsize)count, g_stringClass, nullptr);
+    if (!arr) {
+        env->ExceptionClear();
+        return;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        jstring line = env->NewStringUTF(lines[i]);
+        if (!line) {
+            env->ExceptionClear();
+            continue;
+        }
+        env->SetObjectArrayElement(arr, (jsize)i, line);
+        env->DeleteLocalRef(line);
+    }
+    env->CallStaticVoidMethod(g_mainActivityClass, g_sendLogBatchMethod, arr, (jlong)dropped);
+    if (env->ExceptionCheck()) env->ExceptionClear();
+    env->DeleteLocalRef(arr);
+}
+
+// Result of an engine completion: rc < 0 means the prepare step (preflight) failed with err
+static TransferResult complete_transfer(Transfer& t, int rc, const std::string& err) {
+    if (rc < 0) {
+        release_transfer(t);
+        TransferResult r = error_result(elapsed_ms(t.start), err);
+        r.timing.pinCheckUs = t.preflightUs;
+        return r;
+    }
+    return finish_transfer(t, rc);
+}
+
+// run_preflight, recording its duration for TransferTiming::pinCheckUs
+static bool timed_preflight(JNIEnv* env, Transfer& t) {
+    auto begin = std::chrono::steady_clock::now();
+    bool ok = run_preflight(env, t.spec);
+    t.preflightUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count();
+    return ok;
+}
+
+// Appends a CURLOPT_RESOLVE entry to the transfer's resolve list
+static void add_resolve_entry(Transfer& t, const std::string& entry) {
+    if (entry.empty()) return;
+    const CurlApi& curlApi = native_api().curl;
+    t.resolve_list = curlApi.slist_append(t.resolve_list, entry.c_str());
+    if (t.resolve_list) curlApi.easy_setopt(t.curl, CURLOPT_RESOLVE, t.resolve_list);
+}
+
+// Hands curl the cached addresses for the request's host (resolving on a miss), so
+// curl and the preflight share one lookup per TTL. Runs before the transfer starts.
+static void apply_dns_cache(Transfer& t) {
+    std::string host;
+    int port = 443;
+    parse_host_port(t.spec.url, host, port);
+    add_resolve_entry(t, dns_curl_resolve_entry(host, port));
+}
+
+// EngineJob.prepare for the engine's prepare workers. A DNS cache hit is applied right
+// here on the submitting thread; only a cache miss or the pinning preflight (both may
+// block) get a prepare step, so plain requests go straight to the multi loop.
+static std::function<bool(std::string&)> prepare_step(Transfer* t) {
+    std::string host;
+    int port = 443;
+    parse_host_port(t->spec.url, host, port);
+    std::string entry;
+    bool resolved = dns_curl_cached_entry(host, port, &entry);
+    add_resolve_entry(*t, entry);
+    if (resolved && !t->want_preflight) return nullptr;
+    return [t, resolved](std::string& err) {
+        if (!resolved) apply_dns_cache(*t);
+        if (!t->want_preflight || timed_preflight(attached_env(), *t)) return true;
+        err = "SSL pinning mismatch";
+        return false;
+    };
+}
+
+// Blocking request on the calling thread; shared by nativeHttpRequest, nativePerform and nativeExecute
+static TransferResult perform_transfer(JNIEnv* env, Transfer& t, bool specOk) {
+    if (!specOk) {
+        return error_result(0, "no url");
+    }
+
+    TransferResult err;
+    if (!setup_transfer(t, err)) {
+        return err;
+    }
+
+    apply_dns_cache(t);
+
+    // If pinning pseudo-headers present and preflight desired, perform native pre-flight verification
+    if (t.want_preflight && !timed_preflight(env, t)) {
+        return complete_transfer(t, -1, "SSL pinning mismatch");
+    }
+
+    LOGD("Performing curl request...");
+    int rc = native_api().curl.easy_perform(t.curl);
+    LOGD("curl_easy_perform returned: %d", rc);
+
+    return finish_transfer(t, rc);
+}
+
+static TransferResult perform_blocking(JNIEnv* env, jstring jmethod, jstring jurl, jobject jheadersMap,
+                                       jobject jbody, jint jtimeoutMs) {
+    Transfer t;
+    t.start = std::chrono::steady_clock::now();
+    bool ok = read_request_spec(env, jmethod, jurl, jheadersMap, jbody, jtimeoutMs, t.spec);
+    return perform_transfer(env, t, ok);
+}
+
+// Legacy entry point: same as nativePerform, but returns the result as a JSON string
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_example_fluttida_NativeHttp_nativeHttpRequest(
+        JNIEnv *env,
+        jobject /* this */,
+        jstring jmethod,
+        jstring jurl,
+        jobject jheadersMap,
+        jobject jbody,
+        jint jtimeoutMs) {
+    std::string json = result_json(perform_blocking(env, jmethod, jurl, jheadersMap, jbody, jtimeoutMs));
+    return env->NewStringUTF(json.c_str());
+}
+
+// Blocking request returning a NativeHttp.Result (no JSON round trip)
+extern "C" JNIEXPORT jobject JNICALL
+Java_com_example_fluttida_NativeHttp_nativePerform(
+        JNIEnv *env,
+        jobject /* this */,
+        jstring jmethod,
+        jstring jurl,
+        jobject jheadersMap,
+        jobject jbody,
+        jint jtimeoutMs) {
+    return new_jresult(env, perform_blocking(env, jmethod, jurl, jheadersMap, jbody, jtimeoutMs));
+}
+
+// Typed variant of nativePerform: takes a NativeHttp.Request whose headerPairs/options replace
+// the header Map and X-Curl-* pseudo headers (all field IDs cached in JNI_OnLoad)
+extern "C" JNIEXPORT jobject JNICALL
+Java_com_example_fluttida_NativeHttp_nativeExecute(
+        JNIEnv *env,
+        jobject /* this */,
+        jobject jrequest) {
+    Transfer t;
+    t.start = std::chrono::steady_clock::now();
+    bool ok = read_request_object(env, jrequest, t.spec);
+    return new_jresult(env, perform_transfer(env, t, ok));
+}
+
+// Delivers an async result to NativeHttp.Callback.onComplete(id, result) and drops the global ref
+static void deliver_completion(jobject callback, uint64_t id, const TransferResult& r) {
+    JNIEnv* env = attached_env();
+    if (!env) {
+        // without a JNIEnv there is no way to drop the global ref either
+        LOGE("deliver_completion: no JNIEnv for request %llu, callback not released", (unsigned long long)id);
+        return;
+    }
+    if (g_callbackOnCompleteMethod) {
+        jobject jresult = new_jresult(env, r);
+        env->CallVoidMethod(callback, g_callbackOnCompleteMethod, (jlong)id, jresult);
+        if (env->ExceptionCheck()) {
+            LOGE("deliver_completion: callback threw for request %llu", (unsigned long long)id);
+            env->ExceptionClear();
+        }
+        if (jresult) env->DeleteLocalRef(jresult);
+    }
+    env->DeleteGlobalRef(callback);
+}
+
+// Error for jobs curl_engine_submit refused (the engine thread could not be started)
+static const char* const kEngineDownError = "curl_multi engine not available";
+
+// Completion hook for submit_transfer; runs exactly once, on an engine thread or (for setup
+// errors, id 0) on the submitting thread
+typedef std::function<void(uint64_t id, Transfer& t, const TransferResult& r)> TransferDelivery;
+
+// Queues t (spec already read; specOk false when that failed) on the curl_multi engine and
+// takes ownership of it; shared by nativeSubmit, nativeSubmitRequest and nativeSubmitBody
+static jlong submit_transfer(Transfer* t, bool specOk, TransferDelivery deliver) {
+    TransferResult setupErr;
+    bool ok = false;
+    if (!specOk) {
+        setupErr = error_result(0, "no url");
+    } else if (!setup_transfer(*t, setupErr)) {
+        // setupErr holds the error
+    } else if (!native_api().has(NATIVE_CAP_MULTI)) {
+        release_transfer(*t);
+        setupErr = error_result(elapsed_ms(t->start), "curl_multi not available in this libcurl build");
+    } else {
+        ok = true;
+    }
+    if (!ok) {
+        deliver(0, *t, setupErr);
+        delete t;
+        return 0;
+    }
+
+    EngineJob job;
+    job.curl = t->curl;
+    job.prepare = prepare_step(t);
+    job.done = [t, deliver](uint64_t id, int rc, const std::string& err) {
+        TransferResult result = complete_transfer(*t, rc, err);
+        deliver(id, *t, result);
+        delete t;
+    };
+    uint64_t id = curl_engine_submit(std::move(job));
+    if (id == 0) {
+        // engine failed to start: the job (and its done) was dropped
+        TransferResult result = complete_transfer(*t, -1, kEngineDownError);
+        deliver(0, *t, result);
+        delete t;
+    }
+    return (jlong)id;
+}
+
+// Async variant of nativePerform: queues the request on the curl_multi engine and
+// returns its id immediately. The result arrives via callback.onComplete on an
+// engine thread; setup errors are delivered before this returns.
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_example_fluttida_NativeHttp_nativeSubmit(
+        JNIEnv *env,
+        jobject /* this */,
+        jstring jmethod,
+        jstring jurl,
+        jobject jheadersMap,
+        jobject jbody,
+        jint jtimeoutMs,
+        jobject jcallback) {
+    if (!jcallback) return 0;
+    jobject callback = env->NewGlobalRef(jcallback);
+    auto* t = new Transfer();
+    t->start = std::chrono::steady_clock::now();
+    bool ok = read_request_spec(env, jmethod, jurl, jheadersMap, jbody, jtimeoutMs, t->spec);
+    return submit_transfer(t, ok, [callback](uint64_t id, Transfer&, const TransferResult& r) {
+        deliver_completion(callback, id, r);
+    });
+}
+
+// Typed variant of nativeSubmit (NativeHttp.Request with headerPairs/options, see nativeExecute)
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_example_fluttida_NativeHttp_nativeSubmitRequest(
+        JNIEnv *env,
+        jobject /* this */,
+        jobject jrequest,
+        jobject jcallback) {
+    if (!jcallback) return 0;
+    jobject callback = env->NewGlobalRef(jcallback);
+    auto* t = new Transfer();
+    t->start = std::chrono::steady_clock::now();
+    bool ok = read_request_object(env, jrequest, t->spec);
+    return submit_transfer(t, ok, [callback](uint64_t id, Transfer&, const TransferResult& r) {
+        deliver_completion(callback, id, r);
+    });
+}
+
+// Hands the sealed body block to BodyCallback.onBody(id, ByteBuffer) and drops the global ref.
+// Java owns the block afterwards and must return it through nativeFreeBody.
+static void deliver_body(jobject callback, uint64_t id, BodyBuffer& body, const TransferResult& r) {
+    // Until seal() the block belongs to body, whose destructor frees it on the early returns
+    JNIEnv* env = attached_env();
+    if (!env) {
+        LOGE("deliver_body: no JNIEnv for request %llu, callback not released", (unsigned long long)id);
+        return;
+    }
+    if (!g_bodyCallbackOnBodyMethod) {
+        env->DeleteGlobalRef(callback);
+        return;
+    }
+    size_t total = 0;
+    uint8_t* block = body.seal((int)r.status, r.durationMs, r.errorCode, r.error.empty() ? nullptr : r.error.c_str(),
+                               r.httpVersion, &total);
+    jobject buffer = block ? env->NewDirectByteBuffer(block, (jlong)total) : nullptr;
+    if (block && !buffer) {
+        env->ExceptionClear();
+        free(block);
+    }
+    env->CallVoidMethod(callback, g_bodyCallbackOnBodyMethod, (jlong)id, buffer);
+    if (env->ExceptionCheck()) {
+        LOGE("deliver_body: callback threw for request %llu", (unsigned long long)id);
+        env->ExceptionClear();
+    }
+    if (buffer) env->DeleteLocalRef(buffer);
+    env->DeleteGlobalRef(callback);
+}
+
+// Binary variant of nativeSubmit: the body is written straight into a native block that
+// reaches Java as a direct ByteBuffer (see body_buffer.h for the layout), with no
+// std::string, jstring or byte[] copy on the way.
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_example_fluttida_NativeHttp_nativeSubmitBody(
+        JNIEnv *env,
+        jobject /* this */,
+        jobject jrequest,
+        jobject jcallback) {
+    if (!jcallback) return 0;
+    jobject callback = env->NewGlobalRef(jcallback);
+    auto* transfer = new Transfer();
+    transfer->start = std::chrono::steady_clock::now();
+    transfer->binaryBody = true;
+    bool ok = read_request_object(env, jrequest, transfer->spec);
+    return submit_transfer(transfer, ok, [callback](uint64_t id, Transfer& t, const TransferResult& r) {
+        deliver_body(callback, id, t.body, r);
+    });
+}
+
+// Frees a block delivered by nativeSubmitBody once the bytes have been handed on
+extern "C" JNIEXPORT void JNICALL
+Java_com_example_fluttida_NativeHttp_nativeFreeBody(
+        JNIEnv *env,
+        jobject /* this */,
+        jobject jbuffer) {
+    if (!jbuffer) return;
+    free(env->GetDirectBufferAddress(jbuffer));
+}
+
+// Live streams by token, so acks/cancels from Java never touch a finished StreamState
+static std::mutex g_streamsMutex;
+static std::unordered_map<uint64_t, StreamState*> g_streams;
+static std::atomic<uint64_t> g_nextStreamToken{1};
+
+// Streaming variant of nativeSubmit: body chunks go to callback.onChunk as they arrive,
+// then callback.onComplete(result) with an empty body. windowBytes bounds the un-acked
+// backlog (<= 0 picks 1 MiB). Returns the stream token for nativeStreamAck/Cancel, or 0
+// when the request failed up front (onComplete has been called by then).
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_example_fluttida_NativeHttp_nativeStreamSubmit(
+        JNIEnv *env,
+        jobject /* this */,
+        jobject jrequest,
+        jint jwindowBytes,
+        jobject jcallback) {
+    if (!jcallback) return 0;
+    auto* st = new StreamState();
+    st->token = g_nextStreamToken.fetch_add(1);
+    st->callback = env->NewGlobalRef(jcallback);
+    st->window = jwindowBytes > 0 ? jwindowBytes : 1024 * 1024;
+    {
+        std::lock_guard<std::mutex> lock(g_streamsMutex);
+        g_streams[st->token] = st;
+    }
+
+    auto* t = new Transfer();
+    t->start = std::chrono::steady_clock::now();
+    t->stream = st;
+
+    auto complete = [st](const TransferResult& r) {
+        {
+            std::lock_guard<std::mutex> lock(g_streamsMutex);
+            g_streams.erase(st->token);
+        }
+        JNIEnv* cbEnv = attached_env();
+        if (cbEnv) {
+            if (g_streamOnCompleteMethod) {
+                jobject jresult = new_jresult(cbEnv, r);
+                cbEnv->CallVoidMethod(st->callback, g_streamOnCompleteMethod, jresult);
+                if (cbEnv->ExceptionCheck()) cbEnv->ExceptionClear();
+                if (jresult) cbEnv->DeleteLocalRef(jresult);
             }
+            cbEnv->DeleteGlobalRef(st->callback);
+        } else {
+            LOGE("nativeStreamSubmit: no JNIEnv for stream %llu, callback not released", (unsigned long long)st->token);
         }
+        delete st;
+    };
+
+    TransferResult setupErr;
+    bool ok = false;
+    if (!read_request_object(env, jrequest, t->spec)) {
+        setupErr = error_result(0, "no url");
+    } else if (!setup_transfer(*t, setupErr)) {
+        // setupErr holds the error
+    } else if (!native_api().has(NATIVE_CAP_MULTI)) {
+        release_transfer(*t);
+        setupErr = error_result(elapsed_ms(t->start), "curl_multi not available in this libcurl build");
+    } else {
+        ok = true;
+    }
+    if (!ok) {
+        delete t;
+        complete(setupErr);
+        return 0;
     }
+    st->curl = t->curl;
+    uint64_t token = st->token;
 
-    if (!pin_ok) {
-        if (header_list) curl_slist_free_all(header_list);
-        curl_easy_cleanup(curl);
-        int durationMs = (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
-        std::ostringstream out;
-        out << "{\"status\":null,\"body\":\"\",\"durationMs\":" << durationMs << ",\"error\":\"SSL pinning mismatch\"}";
-        if (jmethod) env->ReleaseStringUTFChars(jmethod, method_c);
-        if (jurl) env->ReleaseStringUTFChars(jurl, url_c);
-        if (jbody) env->ReleaseStringUTFChars(jbody, body_c);
-        std::string json = out.str();
-        return env->NewStringUTF(json.c_str());
+    EngineJob job;
+    job.curl = t->curl;
+    job.prepare = prepare_step(t);
+    job.done = [t, complete](uint64_t, int rc, const std::string& err) {
+        TransferResult result = complete_transfer(*t, rc, err);
+        delete t;
+        complete(result);
+    };
+    if (curl_engine_submit(std::move(job)) == 0) {
+        TransferResult result = complete_transfer(*t, -1, kEngineDownError);
+        delete t;
+        complete(result);
+        return 0;
     }
+    return (jlong)token;
+}
 
-    LOGI("Performing curl request...");
-    int rc = curl_easy_perform(curl);
-    LOGI("curl_easy_perform returned: %d", rc);
-    long status = -1;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+// Consumer has processed `bytes` of a stream; resumes it if that drains the backlog below the window
+extern "C" JNIEXPORT void JNICALL
+Java_com_example_fluttida_NativeHttp_nativeStreamAck(
+        JNIEnv* /*env*/,
+        jobject /* this */,
+        jlong jtoken,
+        jlong jbytes) {
+    uint64_t token = (uint64_t)jtoken;
+    int64_t bytes = jbytes;
+    curl_engine_post([token, bytes] {
+        // Held throughout so a completion on the preflight thread can't free st under us
+        std::lock_guard<std::mutex> lock(g_streamsMutex);
+        auto it = g_streams.find(token);
+        if (it == g_streams.end()) return;
+        StreamState* st = it->second;
+        st->unacked = bytes >= st->unacked ? 0 : st->unacked - bytes;
+        if (st->paused && st->unacked < st->window) {
+            st->paused = false;
+            native_api().curl.easy_pause(st->curl, CURLPAUSE_CONT);
+        }
+    });
+}
 
-    if (header_list) curl_slist_free_all(header_list);
-    curl_easy_cleanup(curl);
-    // dlclose(lib); // Keep loaded to avoid OpenSSL TLS destructor crash
+// Aborts a stream; onComplete still fires (with a write error)
+extern "C" JNIEXPORT void JNICALL
+Java_com_example_fluttida_NativeHttp_nativeStreamCancel(
+        JNIEnv* /*env*/,
+        jobject /* this */,
+        jlong jtoken) {
+    uint64_t token = (uint64_t)jtoken;
+    curl_engine_post([token] {
+        std::lock_guard<std::mutex> lock(g_streamsMutex);
+        auto it = g_streams.find(token);
+        if (it == g_streams.end()) return;
+        StreamState* st = it->second;
+        st->cancelled = true;
+        // A paused transfer never calls the write callback; resume it so it can fail
+        if (st->paused) {
+            st->paused = false;
+            native_api().curl.easy_pause(st->curl, CURLPAUSE_CONT);
+        }
+    });
+}
 
-    int durationMs = (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+// Runs every NativeHttp.Request in the array concurrently on the curl_multi engine and
+// returns the NativeHttp.Results (same order) in a single JNI crossing. Blocks until all finish.
+extern "C" JNIEXPORT jobjectArray JNICALL
+Java_com_example_fluttida_NativeHttp_nativeHttpBatch(
+        JNIEnv *env,
+        jobject /* this */,
+        jobjectArray jrequests) {
+    if (!g_resultClass) return nullptr;
+    jsize n = jrequests ? env->GetArrayLength(jrequests) : 0;
+    jobjectArray out = env->NewObjectArray(n, g_resultClass, nullptr);
+    if (!out || n == 0) return out;
 
-    std::ostringstream out;
-    if (rc == 0) {
-        out << "{\"status\":" << status << ",\"body\":";
-        // JSON-escape resp minimal
-        out << "\"";
-        for (char c : resp) {
-            switch (c) {
-                case '\\': out << "\\\\"; break;
-                case '"': out << "\\\""; break;
-                case '\n': out << "\\n"; break;
-                case '\r': out << "\\r"; break;
-                case '\t': out << "\\t"; break;
-                default: out << c; break;
+    std::vector<Transfer> transfers((size_t)n);
+    std::vector<TransferResult> results((size_t)n);
+    std::vector<size_t> ready; // indices that passed setup
+    for (jsize i = 0; i < n; ++i) {
+        Transfer& t = transfers[i];
+        t.start = std::chrono::steady_clock::now();
+        jobject jreq = env->GetObjectArrayElement(jrequests, i);
+        bool ok = read_request_object(env, jreq, t.spec);
+        if (jreq) env->DeleteLocalRef(jreq);
+        if (!ok) {
+            results[i] = error_result(0, "no url");
+        } else if (setup_transfer(t, results[i])) {
+            ready.push_back((size_t)i);
+        }
+    }
+
+    if (native_api().has(NATIVE_CAP_MULTI)) {
+        std::mutex mu;
+        std::condition_variable cv;
+        size_t pending = ready.size();
+        for (size_t i : ready) {
+            Transfer* t = &transfers[i];
+            EngineJob job;
+            job.curl = t->curl;
+            job.prepare = prepare_step(t);
+            job.done = [t, i, &results, &mu, &cv, &pending](uint64_t, int rc, const std::string& err) {
+                TransferResult result = complete_transfer(*t, rc, err);
+                std::lock_guard<std::mutex> lock(mu);
+                results[i] = std::move(result);
+                if (--pending == 0) cv.notify_one();
+            };
+            if (curl_engine_submit(std::move(job)) == 0) {
+                // engine failed to start: the job (and its done) was dropped
+                TransferResult result = complete_transfer(*t, -1, kEngineDownError);
+                std::lock_guard<std::mutex> lock(mu);
+                results[i] = std::move(result);
+                --pending;
             }
         }
-        out << "\",";
-        out << "\"durationMs\":" << durationMs << ",\"error\":null}";
+        std::unique_lock<std::mutex> lock(mu);
+        cv.wait(lock, [&pending] { return pending == 0; });
     } else {
-        out << "{\"status\":null,\"body\":\"\",\"durationMs\":" << durationMs << ",\"error\":\"curl_easy_perform rc=" << rc;
-        if (curl_easy_strerror) {
-            const char* es = curl_easy_strerror(rc);
-            if (es) {
-                out << " (";
-                // minimal JSON escape for the error string
-                for (const char* p = es; *p; ++p) {
-                    char c = *p;
-                    switch (c) {
-                        case '\\': out << "\\\\"; break;
-                        case '"': out << "\\\""; break;
-                        case '\n': out << "\\n"; break;
-                        case '\r': out << "\\r"; break;
-                        case '\t': out << "\\t"; break;
-                        default: out << c; break;
-                    }
-                }
-                out << ")";
+        // No curl_multi in this libcurl build: fall back to running them one by one
+        for (size_t i : ready) {
+            Transfer& t = transfers[i];
+            apply_dns_cache(t);
+            if (t.want_preflight && !timed_preflight(env, t)) {
+                results[i] = complete_transfer(t, -1, "SSL pinning mismatch");
+                continue;
             }
+            results[i] = finish_transfer(t, native_api().curl.easy_perform(t.curl));
         }
-        out << "\"}";
     }
 
-    if (jmethod) env->ReleaseStringUTFChars(jmethod, method_c);
-    if (jurl) env->ReleaseStringUTFChars(jurl, url_c);
-    if (jbody) env->ReleaseStringUTFChars(jbody, body_c);
+    for (jsize i = 0; i < n; ++i) {
+        jobject jr = new_jresult(env, results[i]);
+        env->SetObjectArrayElement(out, i, jr);
+        if (jr) env->DeleteLocalRef(jr);
+    }
+    return out;
+}
+
+// Caps concurrent HTTP/2 streams per connection on the engine's multi handle (0 = libcurl default)
+extern "C" JNIEXPORT void JNICALL
+Java_com_example_fluttida_NativeHttp_nativeSetHttp2MaxStreams(
+        JNIEnv* /*env*/,
+        jobject /* this */,
+        jint maxStreams) {
+    curl_engine_set_max_streams(maxStreams > 0 ? (long)maxStreams : 0);
+}
+
+// Runtime log floor (android_LogPriority value); levels compiled out of this build stay off
+extern "C" JNIEXPORT void JNICALL
+Java_com_example_fluttida_NativeHttp_nativeSetLogLevel(
+        JNIEnv* /*env*/,
+        jobject /* this */,
+        jint level) {
+    native_log_set_level(level);
+}
+
+// Resolves hosts into the native DNS cache in the background
+extern "C" JNIEXPORT void JNICALL
+Java_com_example_fluttida_NativeHttp_nativeDnsPrefetch(
+        JNIEnv *env,
+        jobject /* this */,
+        jobjectArray jhosts) {
+    if (!jhosts) return;
+    std::vector<std::string> hosts;
+    jsize n = env->GetArrayLength(jhosts);
+    for (jsize i = 0; i < n; ++i) {
+        auto jhost = (jstring)env->GetObjectArrayElement(jhosts, i);
+        if (!jhost) continue;
+        hosts.push_back(jstring_to_std(env, jhost));
+        env->DeleteLocalRef(jhost);
+    }
+    dns_prefetch(hosts);
+}
+
+// Enables/disables the native DNS cache; ttlSeconds <= 0 keeps the current TTL
+extern "C" JNIEXPORT void JNICALL
+Java_com_example_fluttida_NativeHttp_nativeDnsConfigure(
+        JNIEnv* /*env*/,
+        jobject /* this */,
+        jboolean enabled,
+        jint ttlSeconds) {
+    dns_configure(enabled == JNI_TRUE, ttlSeconds);
+}
+
+// Opens the persistent TLS session store at path (app-private file) and loads it
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_example_fluttida_NativeHttp_nativeSessionStoreOpen(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring jpath) {
+    if (!jpath) return JNI_FALSE;
+    return session_store_open(jstring_to_std(env, jpath)) ? JNI_TRUE : JNI_FALSE;
+}
+
+// Forgets every persisted TLS session
+extern "C" JNIEXPORT void JNICALL
+Java_com_example_fluttida_NativeHttp_nativeSessionStoreClear(
+        JNIEnv* /*env*/,
+        jobject /* this */) {
+    session_store_clear();
+}
 
+// Native stack counters as JSON (pool reuse etc.) for the lab's diagnostics
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_example_fluttida_NativeHttp_nativeHttpStats(
+        JNIEnv *env,
+        jobject /* this */) {
+    EasyPoolStats pool = easy_pool().stats();
+    ShareStats share = curl_share_stats();
+    EngineStats engine = curl_engine_stats();
+    DnsStats dns = dns_cache_stats();
+    HappyEyeballsStats connect = happy_eyeballs_stats();
+    PinCacheStats pins = pin_cache_stats();
+    LogRingStats logs = log_ring_stats();
+    SessionStoreStats sessions = session_store_stats();
+    PreflightCtxStats preflight = preflight_ctx_stats();
+    std::ostringstream out;
+    out << "{\"easyPool\":{\"hits\":" << pool.hits << ",\"misses\":" << pool.misses
+        << ",\"evictions\":" << pool.evictions << ",\"idle\":" << pool.idle << "}";
+    out << ",\"share\":{\"dnsLockAcquisitions\":" << share.dnsLockAcquisitions
+        << ",\"sslSessionLockAcquisitions\":" << share.sslSessionLockAcquisitions
+        << ",\"connectLockAcquisitions\":" << share.connectLockAcquisitions << ",\"connReused\":" << share.connReused
+        << ",\"connNew\":" << share.connNew << ",\"tlsResumed\":" << share.tlsResumed
+        << ",\"tlsFull\":" << share.tlsFull << ",\"isolated\":" << share.isolated
+        << ",\"unshared\":" << share.unshared << "}";
+    out << ",\"engine\":{\"backend\":\"" << engine.backend << "\",\"submitted\":" << engine.submitted
+        << ",\"completed\":" << engine.completed << ",\"inFlight\":" << engine.inFlight
+        << ",\"peakInFlight\":" << engine.peakInFlight << ",\"maxStreams\":" << engine.maxStreams << "}";
+    out << ",\"dns\":{\"enabled\":" << (dns.enabled ? "true" : "false") << ",\"ttlSeconds\":" << dns.ttlSeconds
+        << ",\"hits\":" << dns.hits << ",\"misses\":" << dns.misses << ",\"coalesced\":" << dns.coalesced
+        << ",\"failures\":" << dns.failures << ",\"prefetches\":" << dns.prefetches
+        << ",\"lookupUs\":" << dns.lookupUs << ",\"entries\":" << dns.entries << "}";
+    out << ",\"preflightConnect\":{\"v6Wins\":" << connect.v6Wins << ",\"v4Wins\":" << connect.v4Wins
+        << ",\"failures\":" << connect.failures << ",\"timeouts\":" << connect.timeouts << "}";
+    out << ",\"preflightTls\":{\"contexts\":" << preflight.contexts << ",\"created\":" << preflight.created
+        << ",\"sessions\":" << preflight.sessions << ",\"offered\":" << preflight.offered
+        << ",\"resumed\":" << preflight.resumed << ",\"captured\":" << preflight.captured
+        << ",\"ticketReads\":" << preflight.ticketReads << ",\"ticketMisses\":" << preflight.ticketMisses << "}";
+    out << ",\"pinCache\":{\"hits\":" << pins.hits << ",\"misses\":" << pins.misses
+        << ",\"evictions\":" << pins.evictions << ",\"entries\":" << pins.entries
+        << ",\"capacity\":" << pins.capacity << "}";
+    out << ",\"log\":{\"pushed\":" << logs.pushed << ",\"dropped\":" << logs.dropped
+        << ",\"delivered\":" << logs.delivered << ",\"batches\":" << logs.batches
+        << ",\"capacity\":" << logs.capacity << "}";
+    out << ",\"sessionStore\":{\"open\":" << (sessions.open ? "true" : "false") << ",\"entries\":" << sessions.entries
+        << ",\"bytes\":" << sessions.bytes << ",\"loaded\":" << sessions.loaded << ",\"captured\":" << sessions.captured
+        << ",\"offered\":" << sessions.offered << ",\"resumed\":" << sessions.resumed
+        << ",\"rejected\":" << sessions.rejected << ",\"expired\":" << sessions.expired
+        << ",\"evicted\":" << sessions.evicted << ",\"writes\":" << sessions.writes << "}}";
     std::string json = out.str();
     return env->NewStringUTF(json.c_str());
 }
@@ -832,20 +1695,192 @@ extern "C" JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM* vm, void* /*reserved*/) {
         return JNI_ERR;
     }
     
-    // Cache MainActivity class and sendLogToFlutter static method
+    // Cache MainActivity class and its sendLogBatchToFlutter static method
     jclass localClass = env->FindClass("com/example/fluttida/MainActivity");
     if (localClass) {
         g_mainActivityClass = (jclass)env->NewGlobalRef(localClass);
         env->DeleteLocalRef(localClass);
         
-        // Look for static method: public static void sendLogToFlutter(String msg)
-        g_sendLogMethod = env->GetStaticMethodID(g_mainActivityClass, "sendLogToFlutter", "(Ljava/lang/String;)V");
-        if (!g_sendLogMethod) {
-            LOGE("JNI_OnLoad: failed to find sendLogToFlutter method");
+        // Look for static method: public static void sendLogBatchToFlutter(String[] msgs, long dropped)
+        g_sendLogBatchMethod = env->GetStaticMethodID(g_mainActivityClass, "sendLogBatchToFlutter", "([Ljava/lang/String;J)V");
+        if (!g_sendLogBatchMethod) {
+            env->ExceptionClear();
+            LOGE("JNI_OnLoad: failed to find sendLogBatchToFlutter method");
+        }
+        // Java pin verifier used by the preflight when OpenSSL is unavailable
+        g_verifyHostPinsMethod = env->GetStaticMethodID(g_mainActivityClass, "verifyHostPins", "(Ljava/lang/String;ILjava/lang/String;Ljava/lang/String;)Z");
+        if (!g_verifyHostPinsMethod) {
+            env->ExceptionClear();
+            LOGE("JNI_OnLoad: failed to find verifyHostPins method");
         }
     } else {
         LOGE("JNI_OnLoad: failed to find MainActivity class");
     }
+
+    // Completion callback for nativeSubmit (looked up here: engine threads can't FindClass app classes)
+    jclass callbackClass = env->FindClass("com/example/fluttida/NativeHttp$Callback");
+    if (callbackClass) {
+        g_callbackOnCompleteMethod = env->GetMethodID(callbackClass, "onComplete", "(JLcom/example/fluttida/NativeHttp$Result;)V");
+        env->DeleteLocalRef(callbackClass);
+    } else {
+        env->ExceptionClear();
+        LOGE("JNI_OnLoad: failed to find NativeHttp$Callback class");
+    }
+
+    // Completion callback for nativeSubmitBody
+    jclass bodyCallbackClass = env->FindClass("com/example/fluttida/NativeHttp$BodyCallback");
+    if (bodyCallbackClass) {
+        g_bodyCallbackOnBodyMethod = env->GetMethodID(bodyCallbackClass, "onBody", "(JLjava/nio/ByteBuffer;)V");
+        env->DeleteLocalRef(bodyCallbackClass);
+    } else {
+        env->ExceptionClear();
+        LOGE("JNI_OnLoad: failed to find NativeHttp$BodyCallback class");
+    }
+
+    // Chunk/completion callback for nativeStreamSubmit
+    jclass streamCallbackClass = env->FindClass("com/example/fluttida/NativeHttp$StreamCallback");
+    if (streamCallbackClass) {
+        g_streamOnChunkMethod = env->GetMethodID(streamCallbackClass, "onChunk", "([B)V");
+        g_streamOnCompleteMethod = env->GetMethodID(streamCallbackClass, "onComplete", "(Lcom/example/fluttida/NativeHttp$Result;)V");
+        env->DeleteLocalRef(streamCallbackClass);
+    } else {
+        env->ExceptionClear();
+        LOGE("JNI_OnLoad: failed to find NativeHttp$StreamCallback class");
+    }
+
+    // Result object returned by nativePerform/nativeHttpBatch and passed to Callback.onComplete
+    jclass resultClass = env->FindClass("com/example/fluttida/NativeHttp$Result");
+    if (resultClass) {
+        g_resultCtor = env->GetMethodID(resultClass, "<init>", "()V");
+        g_resultStatusField = env->GetFieldID(resultClass, "status", "I");
+        g_resultBodyField = env->GetFieldID(resultClass, "body", "[B");
+        g_resultDurationField = env->GetFieldID(resultClass, "durationMs", "I");
+        g_resultErrorCodeField = env->GetFieldID(resultClass, "errorCode", "I");
+        g_resultErrorField = env->GetFieldID(resultClass, "error", "Ljava/lang/String;");
+        g_resultHttpVersionField = env->GetFieldID(resultClass, "httpVersion", "Ljava/lang/String;");
+        g_resultHeadersField = env->GetFieldID(resultClass, "headers", "[Ljava/lang/String;");
+        g_resultTimingField = env->GetFieldID(resultClass, "timing", "[J");
+        if (env->ExceptionCheck()) {
+            env->ExceptionClear();
+            LOGE("JNI_OnLoad: NativeHttp$Result members not found");
+        } else {
+            g_resultClass = (jclass)env->NewGlobalRef(resultClass);
+        }
+        env->DeleteLocalRef(resultClass);
+    } else {
+        env->ExceptionClear();
+        LOGE("JNI_OnLoad: failed to find NativeHttp$Result class");
+    }
+
+    // Body source classes (FindClass results are only valid for this thread unless promoted)
+    const char* bodyClassNames[] = {"java/lang/String", "[B", "java/nio/ByteBuffer", "java/io/File"};
+    jclass* bodyClassSlots[] = {&g_stringClass, &g_byteArrayClass, &g_byteBufferClass, &g_fileClass};
+    for (size_t i = 0; i < 4; ++i) {
+        jclass cls = env->FindClass(bodyClassNames[i]);
+        if (!cls) {
+            env->ExceptionClear();
+            LOGE("JNI_OnLoad: failed to find %s", bodyClassNames[i]);
+            continue;
+        }
+        *bodyClassSlots[i] = (jclass)env->NewGlobalRef(cls);
+        env->DeleteLocalRef(cls);
+    }
+    if (g_fileClass) g_fileGetPathMethod = env->GetMethodID(g_fileClass, "getPath", "()Ljava/lang/String;");
+    if (g_byteBufferClass) {
+        g_bufferPositionMethod = env->GetMethodID(g_byteBufferClass, "position", "()I");
+        g_bufferLimitMethod = env->GetMethodID(g_byteBufferClass, "limit", "()I");
+        if (!g_bufferPositionMethod || !g_bufferLimitMethod) {
+            env->ExceptionClear();
+            LOGE("JNI_OnLoad: failed to find ByteBuffer position()/limit()");
+        }
+    }
+
+    // Interned response header names, created once and shared by every Result
+    g_headerNameRefs = new jstring[header_common_count()];
+    for (size_t i = 0; i < header_common_count(); ++i) {
+        jstring local = env->NewStringUTF(header_common_name((int)i));
+        g_headerNameRefs[i] = local ? (jstring)env->NewGlobalRef(local) : nullptr;
+        if (local) env->DeleteLocalRef(local);
+    }
+
+    // Request descriptor for nativeExecute/nativeSubmitRequest/nativeSubmitBody/nativeStreamSubmit/nativeHttpBatch
+    jclass requestClass = env->FindClass("com/example/fluttida/NativeHttp$Request");
+    if (requestClass) {
+        g_reqMethodField = env->GetFieldID(requestClass, "method", "Ljava/lang/String;");
+        g_reqUrlField = env->GetFieldID(requestClass, "url", "Ljava/lang/String;");
+        g_reqHeadersField = env->GetFieldID(requestClass, "headers", "Ljava/util/Map;");
+        g_reqBodyField = env->GetFieldID(requestClass, "body", "Ljava/lang/Object;");
+        g_reqTimeoutField = env->GetFieldID(requestClass, "timeoutMs", "I");
+        if (env->ExceptionCheck()) {
+            env->ExceptionClear();
+            g_reqUrlField = nullptr;
+            LOGE("JNI_OnLoad: NativeHttp$Request fields not found");
+        }
+        g_reqHeaderPairsField = env->GetFieldID(requestClass, "headerPairs", "[Ljava/lang/String;");
+        g_reqOptionsField = env->GetFieldID(requestClass, "options", "Lcom/example/fluttida/NativeHttp$Options;");
+        g_reqResponseHeadersField = env->GetFieldID(requestClass, "responseHeaders", "[Ljava/lang/String;");
+        if (env->ExceptionCheck()) {
+            env->ExceptionClear();
+            g_reqHeaderPairsField = nullptr;
+            g_reqOptionsField = nullptr;
+            g_reqResponseHeadersField = nullptr;
+            LOGE("JNI_OnLoad: NativeHttp$Request typed fields not found");
+        }
+        env->DeleteLocalRef(requestClass);
+    } else {
+        env->ExceptionClear();
+        LOGE("JNI_OnLoad: failed to find NativeHttp$Request class");
+    }
+
+    // Typed request options
+    jclass optionsClass = env->FindClass("com/example/fluttida/NativeHttp$Options");
+    if (optionsClass) {
+        g_optInsecureField = env->GetFieldID(optionsClass, "insecure", "Z");
+        g_optCaInfoField = env->GetFieldID(optionsClass, "caInfoPath", "Ljava/lang/String;");
+        g_optSpkiPinsField = env->GetFieldID(optionsClass, "spkiPins", "[Ljava/lang/String;");
+        g_optCertPinsField = env->GetFieldID(optionsClass, "certPins", "[Ljava/lang/String;");
+        g_optTechniqueField = env->GetFieldID(optionsClass, "technique", "Ljava/lang/String;");
+        g_optHttp2Field = env->GetFieldID(optionsClass, "http2", "Z");
+        if (env->ExceptionCheck()) {
+            env->ExceptionClear();
+            g_reqOptionsField = nullptr; // never read options with missing field IDs
+            LOGE("JNI_OnLoad: NativeHttp$Options fields not found");
+        }
+        env->DeleteLocalRef(optionsClass);
+    } else {
+        env->ExceptionClear();
+        g_reqOptionsField = nullptr;
+        LOGE("JNI_OnLoad: failed to find NativeHttp$Options class");
+    }
+
+    // Map<String,String> walk used by the Map-based entry points (interface method IDs)
+    jclass mapClass = env->FindClass("java/util/Map");
+    jclass setClass = env->FindClass("java/util/Set");
+    jclass iterClass = env->FindClass("java/util/Iterator");
+    jclass entryClass = env->FindClass("java/util/Map$Entry");
+    if (mapClass && setClass && iterClass && entryClass) {
+        g_mapEntrySetMethod = env->GetMethodID(mapClass, "entrySet", "()Ljava/util/Set;");
+        g_setIteratorMethod = env->GetMethodID(setClass, "iterator", "()Ljava/util/Iterator;");
+        g_iterHasNextMethod = env->GetMethodID(iterClass, "hasNext", "()Z");
+        g_iterNextMethod = env->GetMethodID(iterClass, "next", "()Ljava/lang/Object;");
+        g_entryGetKeyMethod = env->GetMethodID(entryClass, "getKey", "()Ljava/lang/Object;");
+        g_entryGetValueMethod = env->GetMethodID(entryClass, "getValue", "()Ljava/lang/Object;");
+    }
+    if (env->ExceptionCheck() || !g_entryGetValueMethod) {
+        env->ExceptionClear();
+        g_mapEntrySetMethod = nullptr;
+        LOGE("JNI_OnLoad: java.util.Map members not found");
+    }
+    if (mapClass) env->DeleteLocalRef(mapClass);
+    if (setClass) env->DeleteLocalRef(setClass);
+    if (iterClass) env->DeleteLocalRef(iterClass);
+    if (entryClass) env->DeleteLocalRef(entryClass);
+
+    // Resolve libcurl/libssl/libcrypto once so request and handshake paths never hit the loader
+    native_api();
+
+    // Drainer for the Flutter log ring (needs g_stringClass and the batch method above)
+    if (g_sendLogBatchMethod && g_stringClass) log_ring_start(flutter_log_sink, nullptr);
     
     return JNI_VERSION_1_6;
 }
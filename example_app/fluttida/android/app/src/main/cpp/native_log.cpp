@@ -0,0 +1,9 @@
+#include "native_log.h"
+
+std::atomic<int> g_nativeLogLevel{NLOG_INFO};
+
+void native_log_set_level(int level) {
+    if (level < NLOG_VERBOSE) level = NLOG_VERBOSE;
+    if (level > NLOG_SILENT) level = NLOG_SILENT;
+    g_nativeLogLevel.store(level, std::memory_order_relaxed);
+}
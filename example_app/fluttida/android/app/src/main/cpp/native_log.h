@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+
+#define LOG_TAG "FluttidaNativeHttp"
+
+// Log levels use android_LogPriority values so they pass straight to __android_log_print
+enum NativeLogLevel : int {
+    NLOG_VERBOSE = 2,   // per-handshake / per-callback detail
+    NLOG_DEBUG = 3,     // per-request detail
+    NLOG_INFO = 4,      // one-off events (startup, configuration)
+    NLOG_WARN = 5,
+    NLOG_ERROR = 6,
+    NLOG_SILENT = 8,
+};
+
+// Compile-time floor: call sites below it are dead code and compiled out, arguments
+// included. Release builds (NDEBUG) keep INFO and up; override with -DNATIVE_LOG_MIN_LEVEL.
+#ifndef NATIVE_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define NATIVE_LOG_MIN_LEVEL NLOG_INFO
+#else
+#define NATIVE_LOG_MIN_LEVEL NLOG_VERBOSE
+#endif
+#endif
+
+// Runtime floor, switched from Dart via NativeHttp.setLogLevel (default INFO)
+extern std::atomic<int> g_nativeLogLevel;
+
+inline bool native_log_enabled(int level) {
+    return level >= NATIVE_LOG_MIN_LEVEL && level >= g_nativeLogLevel.load(std::memory_order_relaxed);
+}
+
+// Clamped to [NLOG_VERBOSE, NLOG_SILENT]
+void native_log_set_level(int level);
+
+#ifdef __ANDROID__
+#include <android/log.h>
+
+#define NATIVE_LOG(level, ...) \
+    do { if (native_log_enabled(level)) __android_log_print(level, LOG_TAG, __VA_ARGS__); } while (0)
+#else
+// Plain Linux builds (workstation benchmarks of the engine) log to stderr
+#include <cstdio>
+
+#define NATIVE_LOG(level, ...) \
+    do { \
+        if (native_log_enabled(level)) { \
+            fprintf(stderr, "%c/" LOG_TAG ": ", "??VDIWEF"[level]); \
+            fprintf(stderr, __VA_ARGS__); \
+            fputc('\n', stderr); \
+        } \
+    } while (0)
+#endif
+
+// Arguments are only evaluated when the level is on
+#define LOGV(...) NATIVE_LOG(NLOG_VERBOSE, __VA_ARGS__)
+#define LOGD(...) NATIVE_LOG(NLOG_DEBUG, __VA_ARGS__)
+#define LOGI(...) NATIVE_LOG(NLOG_INFO, __VA_ARGS__)
+#define LOGW(...) NATIVE_LOG(NLOG_WARN, __VA_ARGS__)
+#define LOGE(...) NATIVE_LOG(NLOG_ERROR, __VA_ARGS__)
@@ -0,0 +1,120 @@
+#include "pin_cache.h"
+
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+
+constexpr size_t kCapacity = 256;
+constexpr size_t kMaxPinSets = 1024;
+
+struct Key {
+    uint64_t version;
+    unsigned char digest[32];
+
+    bool operator==(const Key& o) const {
+        return version == o.version && memcmp(digest, o.digest, sizeof(digest)) == 0;
+    }
+};
+
+struct KeyHash {
+    size_t operator()(const Key& k) const {
+        // the digest is already uniformly distributed; fold in the version
+        uint64_t h;
+        memcpy(&h, k.digest, sizeof(h));
+        return (size_t)(h ^ (k.version * 0x9E3779B97F4A7C15ull));
+    }
+};
+
+struct Entry {
+    Key key;
+    bool match;
+};
+
+struct Cache {
+    std::mutex mutex;
+    std::list<Entry> lru;   // front = most recently used
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+    std::unordered_map<std::string, uint64_t> versions;
+    uint64_t nextVersion = 1;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+};
+
+Cache& cache() {
+    // Never destroyed: verify callbacks may still run on curl threads at exit
+    static Cache* c = new Cache();
+    return *c;
+}
+
+Key make_key(uint64_t version, const unsigned char leafSha256[32]) {
+    Key k;
+    k.version = version;
+    memcpy(k.digest, leafSha256, sizeof(k.digest));
+    return k;
+}
+
+}  // namespace
+
+uint64_t pin_set_version(const std::string& certPinsCsv, const std::string& spkiPinsCsv) {
+    if (certPinsCsv.empty() && spkiPinsCsv.empty()) return 0;
+    std::string id = certPinsCsv + '\n' + spkiPinsCsv;
+    Cache& c = cache();
+    std::lock_guard<std::mutex> lock(c.mutex);
+    auto it = c.versions.find(id);
+    if (it != c.versions.end()) return it->second;
+    // Forgetting old ids is safe: versions keep increasing, so a re-registered set just
+    // starts with a cold cache and the old verdicts age out of the LRU
+    if (c.versions.size() >= kMaxPinSets) c.versions.clear();
+    uint64_t v = c.nextVersion++;
+    c.versions.emplace(std::move(id), v);
+    return v;
+}
+
+int pin_verdict_lookup(uint64_t version, const unsigned char leafSha256[32]) {
+    Cache& c = cache();
+    Key k = make_key(version, leafSha256);
+    std::lock_guard<std::mutex> lock(c.mutex);
+    auto it = c.index.find(k);
+    if (it == c.index.end()) {
+        ++c.misses;
+        return -1;
+    }
+    ++c.hits;
+    c.lru.splice(c.lru.begin(), c.lru, it->second);
+    return it->second->match ? 1 : 0;
+}
+
+void pin_verdict_store(uint64_t version, const unsigned char leafSha256[32], bool match) {
+    Cache& c = cache();
+    Key k = make_key(version, leafSha256);
+    std::lock_guard<std::mutex> lock(c.mutex);
+    auto it = c.index.find(k);
+    if (it != c.index.end()) {
+        it->second->match = match;
+        c.lru.splice(c.lru.begin(), c.lru, it->second);
+        return;
+    }
+    if (c.lru.size() >= kCapacity) {
+        c.index.erase(c.lru.back().key);
+        c.lru.pop_back();
+        ++c.evictions;
+    }
+    c.lru.push_front(Entry{k, match});
+    c.index.emplace(k, c.lru.begin());
+}
+
+PinCacheStats pin_cache_stats() {
+    Cache& c = cache();
+    std::lock_guard<std::mutex> lock(c.mutex);
+    PinCacheStats st{};
+    st.hits = c.hits;
+    st.misses = c.misses;
+    st.evictions = c.evictions;
+    st.entries = c.lru.size();
+    st.capacity = kCapacity;
+    return st;
+}
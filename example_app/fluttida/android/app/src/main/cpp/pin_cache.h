@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Process-wide verdict cache for certificate pinning.
+//
+// Maps (pin-set version, SHA-256 of the leaf's DER encoding) to match / mismatch.
+// A repeat handshake against an unchanged leaf only hashes the DER for the key and
+// skips SPKI extraction, base64 encoding and the pin comparisons. Bounded LRU; the
+// verdict covers the pins only, chain verification still runs in OpenSSL.
+
+struct PinCacheStats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    size_t entries;
+    size_t capacity;
+};
+
+// Stable non-zero id for a pin set: equal CSV pairs share a version, any other
+// set gets a fresh one, so stale verdicts can never match. 0 = no pins.
+uint64_t pin_set_version(const std::string& certPinsCsv, const std::string& spkiPinsCsv);
+
+// 1 match, 0 mismatch, -1 not cached (counts a hit or a miss)
+int pin_verdict_lookup(uint64_t version, const unsigned char leafSha256[32]);
+
+void pin_verdict_store(uint64_t version, const unsigned char leafSha256[32], bool match);
+
+PinCacheStats pin_cache_stats();
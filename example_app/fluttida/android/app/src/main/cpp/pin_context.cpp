@@ -0,0 +1,52 @@
+#include "pin_context.h"
+
+#include "native_api.h"
+#include "native_log.h"
+
+namespace {
+
+using Holder = std::shared_ptr<const PinMatcher>;
+
+void free_holder(void* /*parent*/, void* ptr, void* /*ad*/, int /*idx*/, long /*argl*/, void* /*argp*/) {
+    delete static_cast<Holder*>(ptr);
+}
+
+// Allocated once per process; -1 if the TLS library refused or lacks the API
+int ex_index() {
+    static const int idx = [] {
+        if (!native_api().has(NATIVE_CAP_SSLCTX_DATA)) return -1;
+        int i = native_ssl_ctx_ex_new_index(free_holder);
+        if (i < 0) LOGE("pin_context: SSL_CTX ex_data index allocation failed");
+        return i;
+    }();
+    return idx;
+}
+
+}  // namespace
+
+bool pin_context_attach(void* sslCtx, const std::shared_ptr<const PinMatcher>& pins) {
+    int idx = ex_index();
+    if (idx < 0 || !sslCtx || !pins) return false;
+    const SslApi& ssl = native_api().ssl;
+    // ex_data does not run the free callback on overwrite
+    delete static_cast<Holder*>(ssl.SSL_CTX_get_ex_data(sslCtx, idx));
+    Holder* h = new Holder(pins);
+    if (ssl.SSL_CTX_set_ex_data(sslCtx, idx, h) != 1) {
+        delete h;
+        ssl.SSL_CTX_set_ex_data(sslCtx, idx, nullptr);
+        return false;
+    }
+    return true;
+}
+
+const PinMatcher* pin_context_for_store(void* x509StoreCtx) {
+    int idx = ex_index();
+    if (idx < 0 || !x509StoreCtx) return nullptr;
+    const NativeApi& api = native_api();
+    void* ssl = api.crypto.X509_STORE_CTX_get_ex_data(x509StoreCtx, api.ssl.SSL_get_ex_data_X509_STORE_CTX_idx());
+    if (!ssl) return nullptr;
+    void* sslCtx = api.ssl.SSL_get_SSL_CTX(ssl);
+    if (!sslCtx) return nullptr;
+    auto* h = static_cast<Holder*>(api.ssl.SSL_CTX_get_ex_data(sslCtx, idx));
+    return h ? h->get() : nullptr;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <memory>
+
+#include "pin_matcher.h"
+
+// Per-connection pin context for the CURLOPT_SSL_CTX_FUNCTION technique.
+//
+// curl builds one SSL_CTX per connection and hands it to the SSL_CTX callback. The
+// request's compiled matcher is stored in that SSL_CTX's ex_data (a reference held
+// until OpenSSL frees the context), and the verify callback finds it again through
+// X509_STORE_CTX -> SSL -> SSL_CTX. Concurrent requests with different pins never
+// see each other's context, so pinned traffic does not need to be serialized.
+
+// Attaches pins to sslCtx, replacing any earlier context. False when the ex_data
+// API is unavailable (NATIVE_CAP_SSLCTX_DATA) or pins is null.
+bool pin_context_attach(void* sslCtx, const std::shared_ptr<const PinMatcher>& pins);
+
+// Matcher of the connection being verified, or nullptr. Valid for the duration of
+// the verify callback (the SSL_CTX keeps its reference alive).
+const PinMatcher* pin_context_for_store(void* x509StoreCtx);
@@ -0,0 +1,139 @@
+#include "pin_matcher.h"
+#include "native_log.h"
+#include "pin_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+namespace {
+
+constexpr size_t kMaxCompiled = 64;
+
+using Digest = std::array<unsigned char, 32>;
+
+// base64 value per byte, -1 for anything else; accepts the standard and URL-safe alphabets
+struct B64Table {
+    signed char v[256];
+    B64Table() {
+        memset(v, -1, sizeof(v));
+        for (int i = 0; i < 26; ++i) {
+            v['A' + i] = (signed char)i;
+            v['a' + i] = (signed char)(26 + i);
+        }
+        for (int i = 0; i < 10; ++i) v['0' + i] = (signed char)(52 + i);
+        v['+'] = v['-'] = 62;
+        v['/'] = v['_'] = 63;
+    }
+};
+
+const B64Table kB64;
+
+// memcmp ordering: std::array's operator< compares byte by byte and is several times slower
+bool digest_less(const Digest& a, const Digest& b) {
+    return memcmp(a.data(), b.data(), a.size()) < 0;
+}
+
+bool digest_equal(const Digest& a, const Digest& b) {
+    return memcmp(a.data(), b.data(), a.size()) == 0;
+}
+
+// Decodes base64 of exactly 32 bytes (43 chars plus optional '=')
+bool decode_digest(const char* p, size_t n, unsigned char out[32]) {
+    while (n > 0 && p[n - 1] == '=') --n;
+    if (n != 43) return false;
+    uint32_t acc = 0;
+    int bits = 0;
+    size_t o = 0;
+    for (size_t i = 0; i < n; ++i) {
+        int v = kB64.v[(unsigned char)p[i]];
+        if (v < 0) return false;
+        acc = (acc << 6) | (uint32_t)v;
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            out[o++] = (unsigned char)(acc >> bits);
+        }
+    }
+    return o == 32;
+}
+
+bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+struct Registry {
+    std::mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<const PinMatcher>> compiled;
+};
+
+Registry& registry() {
+    static Registry* r = new Registry();
+    return *r;
+}
+
+}  // namespace
+
+PinSet PinSet::compile(const std::string& csv, size_t* rejected) {
+    PinSet set;
+    size_t bad = 0;
+    size_t pos = 0;
+    while (pos <= csv.size()) {
+        size_t end = csv.find(',', pos);
+        if (end == std::string::npos) end = csv.size();
+        size_t b = pos, e = end;
+        // same normalisation the CSV scan used: anything up to "sha256/" is dropped
+        size_t prefix = std::string_view(csv.data() + b, e - b).find("sha256/");
+        if (prefix != std::string_view::npos) b += prefix + 7;
+        while (b < e && is_space(csv[b])) ++b;
+        while (e > b && is_space(csv[e - 1])) --e;
+        if (e > b) {
+            Digest d;
+            if (decode_digest(csv.data() + b, e - b, d.data())) set.digests_.push_back(d);
+            else ++bad;
+        }
+        pos = end + 1;
+    }
+    std::sort(set.digests_.begin(), set.digests_.end(), digest_less);
+    set.digests_.erase(std::unique(set.digests_.begin(), set.digests_.end(), digest_equal), set.digests_.end());
+    if (rejected) *rejected = bad;
+    return set;
+}
+
+bool PinSet::contains(const unsigned char digest[32]) const {
+    Digest key;
+    memcpy(key.data(), digest, key.size());
+    auto it = std::lower_bound(digests_.begin(), digests_.end(), key, digest_less);
+    return it != digests_.end() && digest_equal(*it, key);
+}
+
+std::shared_ptr<const PinMatcher> pin_matcher_compile(const std::string& certPinsCsv,
+                                                      const std::string& spkiPinsCsv) {
+    if (certPinsCsv.empty() && spkiPinsCsv.empty()) return nullptr;
+    std::string id = certPinsCsv + '\n' + spkiPinsCsv;
+    Registry& r = registry();
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        auto it = r.compiled.find(id);
+        if (it != r.compiled.end()) return it->second;
+    }
+
+    auto m = std::make_shared<PinMatcher>();
+    size_t badCert = 0, badSpki = 0;
+    m->cert = PinSet::compile(certPinsCsv, &badCert);
+    m->spki = PinSet::compile(spkiPinsCsv, &badSpki);
+    m->version = pin_set_version(certPinsCsv, spkiPinsCsv);
+    if (badCert || badSpki) {
+        LOGE("pin_matcher: skipped %zu cert / %zu SPKI pins that are not base64 SHA-256 digests", badCert, badSpki);
+    }
+    LOGI("pin_matcher: compiled %zu cert + %zu SPKI pins (version %llu)", m->cert.size(), m->spki.size(),
+         (unsigned long long)m->version);
+
+    std::lock_guard<std::mutex> lock(r.mutex);
+    // Requests keep their own reference, so dropping the table only costs a recompile
+    if (r.compiled.size() >= kMaxCompiled) r.compiled.clear();
+    auto res = r.compiled.emplace(std::move(id), std::move(m));
+    return res.first->second;
+}
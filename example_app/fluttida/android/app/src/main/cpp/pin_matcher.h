@@ -0,0 +1,38 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Pin lists compiled once into raw SHA-256 digests.
+//
+// The CSV form ("sha256/<base64>, ...") is parsed, base64-decoded and sorted when a
+// request is set up; a handshake then only does a binary search over 32-byte digests
+// instead of re-splitting, trimming and string-comparing the CSV.
+
+class PinSet {
+public:
+    // Tokens that are not base64 of exactly 32 bytes are skipped and counted in *rejected.
+    static PinSet compile(const std::string& csv, size_t* rejected = nullptr);
+
+    bool contains(const unsigned char digest[32]) const;
+    size_t size() const { return digests_.size(); }
+    bool empty() const { return digests_.empty(); }
+
+private:
+    std::vector<std::array<unsigned char, 32>> digests_; // sorted, unique
+};
+
+struct PinMatcher {
+    uint64_t version = 0;   // pin_set_version of the source CSVs (verdict cache key)
+    PinSet cert;            // SHA-256 of the leaf's DER encoding
+    PinSet spki;            // SHA-256 of the leaf's SubjectPublicKeyInfo
+};
+
+// Compiled matcher for a CSV pair, shared by every request with the same pins;
+// nullptr when both lists are empty.
+std::shared_ptr<const PinMatcher> pin_matcher_compile(const std::string& certPinsCsv,
+                                                      const std::string& spkiPinsCsv);
@@ -0,0 +1,156 @@
+#include "pin_verify.h"
+
+#include <cstdlib>
+#include <string>
+
+#include <curl/curl.h>
+
+#include "log_ring.h"
+#include "native_api.h"
+#include "native_log.h"
+#include "pin_cache.h"
+#include "pin_context.h"
+
+namespace {
+
+// Minimal base64 encoder for 32-byte input
+std::string base64_encode_32(const unsigned char in[32]) {
+    static const char b64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    char out[48];
+    int outlen = 0;
+    unsigned int val = 0;
+    int valb = -6;
+    for (int i = 0; i < 32; ++i) {
+        val = (val << 8) + in[i];
+        valb += 8;
+        while (valb >= 0) {
+            out[outlen++] = b64[(val >> valb) & 0x3F];
+            valb -= 6;
+        }
+    }
+    if (valb > -6) out[outlen++] = b64[((val << 8) >> (valb + 8)) & 0x3F];
+    while (outlen % 4) out[outlen++] = '=';
+    return std::string(out, outlen);
+}
+
+} // namespace
+
+bool pin_verify_leaf(void* cert, const PinMatcher& pins, const char* tag) {
+    const CryptoApi& cryptoApi = native_api().crypto;
+    unsigned char* certbuf = nullptr;
+    int certlen = cryptoApi.i2d_X509(cert, &certbuf);
+    if (certlen <= 0 || !certbuf) {
+        LOGE("pin_verify_leaf: i2d_X509 failed");
+        return false;
+    }
+    unsigned char digest[32];
+    cryptoApi.SHA256(certbuf, certlen, digest);
+    free(certbuf);
+    int cached = pin_verdict_lookup(pins.version, digest);
+    if (cached >= 0) {
+        LOGD("pin_verify_leaf: cached verdict %d (%s)", cached, tag);
+        log_ring_push(cached ? "[PIN DEBUG] ✓ Pin matched (cached verdict)"
+                                : "[PIN DEBUG] ✗ Pin mismatch (cached verdict)");
+        return cached == 1;
+    }
+
+    std::string certB64 = base64_encode_32(digest);
+    log_ring_push("[NativeCurl/%s] Server Cert SHA256: %s", tag, certB64.c_str());
+    bool ok = pins.cert.contains(digest);
+    if (!pins.cert.empty()) {
+        LOGD("pin_verify_leaf: cert hash %s %s %zu cert pins", certB64.c_str(), ok ? "matches one of" : "matches none of",
+             pins.cert.size());
+        log_ring_push(ok ? "[PIN DEBUG] ✓ Pin matched" : "[PIN DEBUG] ✗ No matching cert hash pin found");
+    }
+
+    if (!ok && !pins.spki.empty()) {
+        void* pkey = cryptoApi.X509_get_pubkey(cert);
+        if (pkey) {
+            unsigned char* pkbuf = nullptr;
+            int pklen = cryptoApi.i2d_PUBKEY(pkey, &pkbuf);
+            if (pklen > 0 && pkbuf) {
+                unsigned char pdigest[32];
+                cryptoApi.SHA256(pkbuf, pklen, pdigest);
+                free(pkbuf);
+                ok = pins.spki.contains(pdigest);
+                std::string pkB64 = base64_encode_32(pdigest);
+                LOGD("pin_verify_leaf: SPKI hash %s %s %zu SPKI pins", pkB64.c_str(),
+                     ok ? "matches one of" : "matches none of", pins.spki.size());
+                log_ring_push("[NativeCurl/%s] Server SPKI SHA256: %s", tag, pkB64.c_str());
+                log_ring_push(ok ? "[PIN DEBUG] ✓ Pin matched" : "[PIN DEBUG] ✗ No matching SPKI pin found");
+            }
+            cryptoApi.EVP_PKEY_free(pkey);
+        }
+    }
+
+    pin_verdict_store(pins.version, digest, ok);
+    return ok;
+}
+
+bool pin_verify_peer(void* ssl, const PinMatcher& pins, const char* tag) {
+    const NativeApi& api = native_api();
+    void* peer = ssl ? api.ssl.SSL_get_peer_certificate(ssl) : nullptr;
+    if (!peer) {
+        LOGE("pin_verify_peer: no peer certificate (%s)", tag);
+        return false;
+    }
+    bool ok = pin_verify_leaf(peer, pins, tag);
+    api.crypto.X509_free(peer);
+    return ok;
+}
+
+int pin_verify_callback(int preverify_ok, void* x509_ctx) {
+    LOGV("=== pin_verify_callback called, preverify_ok=%d ===", preverify_ok);
+
+    // libcrypto symbols were resolved once into the dispatch table
+    const NativeApi& api = native_api();
+    if (!api.has(NATIVE_CAP_VERIFY_CB)) {
+        LOGE("pin_verify_callback: OpenSSL symbols unavailable");
+        return 0; // fail closed
+    }
+    const CryptoApi& cryptoApi = api.crypto;
+
+    // Only verify the leaf certificate (depth 0); allow intermediates/roots to pass
+    int depth = cryptoApi.X509_STORE_CTX_get_error_depth(x509_ctx);
+    LOGV("pin_verify_callback: cert depth=%d", depth);
+    if (depth != 0) {
+        LOGV("pin_verify_callback: accepting intermediate/root cert at depth %d", depth);
+        return 1; // Accept intermediate/root certs
+    }
+
+    LOGV("pin_verify_callback: checking LEAF cert (depth 0)");
+    // pins of the request that opened this connection (SSL_CTX ex_data)
+    const PinMatcher* pins = pin_context_for_store(x509_ctx);
+    if (!pins) {
+        LOGE("pin_verify_callback: no pin context on this connection");
+        return 0;
+    }
+
+    void* cert = cryptoApi.X509_STORE_CTX_get_current_cert(x509_ctx);
+    if (!cert) { 
+        LOGE("pin_verify_callback: failed to get current cert");
+        return 0; 
+    }
+
+    bool ok = pin_verify_leaf(cert, *pins, "SSL_CTX");
+
+    LOGV("pin_verify_callback: returning %d (1=success, 0=fail)", ok ? 1 : 0);
+    return ok ? 1 : 0; // 1 = verification success
+}
+
+int pin_verify_install(void* sslCtx, const std::shared_ptr<const PinMatcher>& pins) {
+    const NativeApi& api = native_api();
+    if (!api.has(NATIVE_CAP_SSLCTX)) {
+        LOGW("pin_verify_install: SSL_CTX_set_verify unavailable");
+        return 1; // can't set, allow
+    }
+    // the connection may outlive the request: the SSL_CTX takes its own reference
+    if (!pin_context_attach(sslCtx, pins)) {
+        LOGE("pin_verify_install: could not attach pin context");
+        return CURLE_SSL_CERTPROBLEM; // fail closed rather than verify without pins
+    }
+    // SSL_VERIFY_PEER (0x01): our callback replaces the default leaf verification
+    api.ssl.SSL_CTX_set_verify(sslCtx, 0x01 /*SSL_VERIFY_PEER*/, pin_verify_callback);
+    LOGV("pin_verify_install: pin_verify_callback registered");
+    return 0;
+}
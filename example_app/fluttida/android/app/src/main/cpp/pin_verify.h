@@ -0,0 +1,34 @@
+#pragma once
+
+#include <memory>
+
+#include "pin_matcher.h"
+
+// Pin checks against the certificates of real TLS connections, shared by every
+// pinning technique:
+//  - sslctx:    pin_verify_install puts pin_verify_callback on curl's per-connection
+//               SSL_CTX, so the leaf is checked during chain verification;
+//  - handshake: pin_verify_peer inspects the SSL curl negotiated, before any request
+//               bytes are sent;
+//  - preflight: pin_verify_peer on the separate preflight connection.
+// All of them end in pin_verify_leaf. The module is JNI-free, so host tools drive the
+// same code as the app.
+
+// Hashes a leaf certificate (full DER, then SPKI only if needed) and looks the digests
+// up in the compiled pin sets. tag names the technique in the log lines sent to Flutter
+// (through the native log ring, so the handshake never waits on JNI). The verdict is
+// cached per leaf DER digest, so a repeat leaf costs one SHA-256.
+bool pin_verify_leaf(void* cert, const PinMatcher& pins, const char* tag);
+
+// pin_verify_leaf on the peer certificate of a connected SSL; false (fail closed) when
+// there is none.
+bool pin_verify_peer(void* ssl, const PinMatcher& pins, const char* tag);
+
+// SSL_CTX verify callback: accepts intermediates and roots, and checks the leaf (depth 0)
+// against the pins attached to the connection's SSL_CTX.
+int pin_verify_callback(int preverify_ok, void* x509_ctx);
+
+// sslctx technique, called from CURLOPT_SSL_CTX_FUNCTION: attaches pins to sslCtx and
+// installs pin_verify_callback with SSL_VERIFY_PEER. Returns the CURLcode for the
+// callback (0 on success).
+int pin_verify_install(void* sslCtx, const std::shared_ptr<const PinMatcher>& pins);
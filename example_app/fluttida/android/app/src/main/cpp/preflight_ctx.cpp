@@ -0,0 +1,362 @@
+#include "preflight_ctx.h"
+
+#include "native_api.h"
+#include "native_log.h"
+
+#include <atomic>
+#include <chrono>
+#include <fcntl.h>
+#include <mutex>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+constexpr size_t kMaxContexts = 8;
+constexpr size_t kMaxSessions = 64;     // per context
+constexpr size_t kMaxTicketReads = 32;  // connections waiting for a ticket at once
+// A ticket follows the handshake by about a round trip; wait twice the handshake
+constexpr int64_t kTicketWaitMinUs = 50 * 1000;
+constexpr int64_t kTicketWaitMaxUs = 1000 * 1000;
+
+// ssl.h values shared by OpenSSL and BoringSSL
+constexpr int kVerifyPeer = 0x01;                   // SSL_VERIFY_PEER
+constexpr int kSessCacheClient = 0x0001;            // SSL_SESS_CACHE_CLIENT
+constexpr int kSessCacheNoInternal = 0x0300;        // SSL_SESS_CACHE_NO_INTERNAL
+constexpr int kErrorWantRead = 2;                   // SSL_ERROR_WANT_READ
+
+// ALPN wire format: length-prefixed protocol names, most preferred first
+const unsigned char kAlpn[] = {2, 'h', '2', 8, 'h', 't', 't', 'p', '/', '1', '.', '1'};
+
+struct PreflightContext {
+    void* ctx = nullptr;
+    bool resumable = false;     // session cache configured (NATIVE_CAP_PREFLIGHT_RESUME)
+    std::mutex mutex;
+    std::unordered_map<std::string, void*> sessions;   // origin -> SSL_SESSION (owned)
+
+    ~PreflightContext() {
+        const SslApi& ssl = native_api().ssl;
+        for (auto& kv : sessions) ssl.SSL_SESSION_free(kv.second);
+        // handshakes still running hold their own reference through SSL_new
+        if (ctx) ssl.SSL_CTX_free(ctx);
+    }
+};
+
+static std::mutex g_ctxMutex;
+static std::unordered_map<std::string, std::shared_ptr<PreflightContext>> g_contexts;
+static std::atomic<uint64_t> g_created{0};
+static std::atomic<uint64_t> g_offered{0};
+static std::atomic<uint64_t> g_resumed{0};
+static std::atomic<uint64_t> g_captured{0};
+static std::atomic<uint64_t> g_ticketReads{0};
+static std::atomic<uint64_t> g_ticketMisses{0};
+
+// The handshake whose new-session callback may fire on this thread (set around
+// SSL_connect and the reader's SSL_peek, which run on the calling thread)
+static thread_local PreflightTls* t_capture = nullptr;
+
+static int new_session_cb(void* ssl, void* session) {
+    PreflightTls* tls = t_capture;
+    if (!tls || tls->ssl != ssl) return 0;
+    if (tls->fresh) native_api().ssl.SSL_SESSION_free(tls->fresh);
+    tls->fresh = session;
+    return 1;   // we own the reference now
+}
+
+static std::shared_ptr<PreflightContext> build_context(const std::string& caInfoPath, bool insecure) {
+    const NativeApi& api = native_api();
+    const SslApi& ssl = api.ssl;
+    auto pc = std::make_shared<PreflightContext>();
+    pc->ctx = ssl.SSL_CTX_new(ssl.TLS_client_method());
+    if (!pc->ctx) return nullptr;
+
+    if (!insecure && !caInfoPath.empty()) {
+        if (ssl.SSL_CTX_load_verify_locations &&
+            ssl.SSL_CTX_load_verify_locations(pc->ctx, caInfoPath.c_str(), nullptr) == 1) {
+            ssl.SSL_CTX_set_verify(pc->ctx, kVerifyPeer, nullptr);
+        } else {
+            LOGW("preflight: could not load CA bundle %s, checking pins only", caInfoPath.c_str());
+        }
+    }
+    if (ssl.SSL_CTX_set_alpn_protos) ssl.SSL_CTX_set_alpn_protos(pc->ctx, kAlpn, sizeof(kAlpn));
+    if (native_ssl_ctx_set_session_cache_mode(pc->ctx, kSessCacheClient | kSessCacheNoInternal)) {
+        ssl.SSL_CTX_sess_set_new_cb(pc->ctx, new_session_cb);
+        pc->resumable = true;
+    }
+    g_created.fetch_add(1, std::memory_order_relaxed);
+    LOGD("preflight: new SSL_CTX for %s (session cache %s)", insecure ? "insecure" : caInfoPath.c_str(),
+         pc->resumable ? "on" : "off");
+    return pc;
+}
+
+static std::shared_ptr<PreflightContext> context_for(const std::string& caInfoPath, bool insecure) {
+    std::string key = std::string(insecure ? "insecure" : "verify") + "|" + caInfoPath;
+    std::lock_guard<std::mutex> lock(g_ctxMutex);
+    auto it = g_contexts.find(key);
+    if (it != g_contexts.end()) return it->second;
+    auto pc = build_context(caInfoPath, insecure);
+    if (!pc) return nullptr;
+    if (g_contexts.size() >= kMaxContexts) g_contexts.erase(g_contexts.begin());
+    g_contexts.emplace(key, pc);
+    return pc;
+}
+
+PreflightTls::~PreflightTls() {
+    if (ssl || fresh || fd >= 0) preflight_tls_end(*this, false);
+}
+
+bool preflight_tls_begin(PreflightTls& tls, const std::string& caInfoPath, bool insecure,
+                         const std::string& host, int port, int fd) {
+    const NativeApi& api = native_api();
+    if (!api.has(NATIVE_CAP_PREFLIGHT)) return false;
+    tls.ctx = context_for(caInfoPath, insecure);
+    if (!tls.ctx) return false;
+    const SslApi& ssl = api.ssl;
+    tls.ssl = ssl.SSL_new(tls.ctx->ctx);
+    if (!tls.ssl) {
+        tls.ctx.reset();
+        return false;
+    }
+    tls.fd = fd;
+    tls.origin = host + ":" + std::to_string(port);
+    native_ssl_set_host_name(tls.ssl, host.c_str());
+    ssl.SSL_set_fd(tls.ssl, fd);
+    if (tls.ctx->resumable) {
+        std::lock_guard<std::mutex> lock(tls.ctx->mutex);
+        auto it = tls.ctx->sessions.find(tls.origin);
+        if (it != tls.ctx->sessions.end() && ssl.SSL_set_session(tls.ssl, it->second) == 1) {
+            tls.offered = true;
+        }
+    }
+    if (tls.offered) g_offered.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool preflight_tls_connect(PreflightTls& tls) {
+    const SslApi& ssl = native_api().ssl;
+    auto begin = std::chrono::steady_clock::now();
+    t_capture = &tls;
+    tls.connected = ssl.SSL_connect(tls.ssl) == 1;
+    t_capture = nullptr;
+    tls.handshakeUs = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - begin).count();
+    if (tls.connected && tls.offered && ssl.SSL_session_reused && ssl.SSL_session_reused(tls.ssl)) {
+        tls.resumed = true;
+        g_resumed.fetch_add(1, std::memory_order_relaxed);
+    }
+    return tls.connected;
+}
+
+// Moves the session from the new-session callback into the origin's slot
+static void store_session(PreflightTls& tls) {
+    const SslApi& ssl = native_api().ssl;
+    if (!tls.fresh) return;
+    if (ssl.SSL_SESSION_is_resumable && !ssl.SSL_SESSION_is_resumable(tls.fresh)) return;
+    std::lock_guard<std::mutex> lock(tls.ctx->mutex);
+    auto it = tls.ctx->sessions.find(tls.origin);
+    if (it != tls.ctx->sessions.end()) {
+        ssl.SSL_SESSION_free(it->second);
+        it->second = tls.fresh;
+    } else {
+        if (tls.ctx->sessions.size() >= kMaxSessions) {
+            auto victim = tls.ctx->sessions.begin();
+            ssl.SSL_SESSION_free(victim->second);
+            tls.ctx->sessions.erase(victim);
+        }
+        tls.ctx->sessions.emplace(tls.origin, tls.fresh);
+    }
+    tls.fresh = nullptr;
+    g_captured.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void forget_session(PreflightTls& tls) {
+    std::lock_guard<std::mutex> lock(tls.ctx->mutex);
+    auto it = tls.ctx->sessions.find(tls.origin);
+    if (it != tls.ctx->sessions.end()) {
+        native_api().ssl.SSL_SESSION_free(it->second);
+        tls.ctx->sessions.erase(it);
+    }
+}
+
+static void release(PreflightTls& tls) {
+    const SslApi& ssl = native_api().ssl;
+    if (tls.ssl && tls.connected && ssl.SSL_shutdown) {
+        // close_notify: OpenSSL marks the session of a connection freed without one
+        // as not resumable
+        ssl.SSL_shutdown(tls.ssl);
+    }
+    if (tls.fresh) {
+        ssl.SSL_SESSION_free(tls.fresh);
+        tls.fresh = nullptr;
+    }
+    if (tls.ssl) {
+        ssl.SSL_free(tls.ssl);
+        tls.ssl = nullptr;
+    }
+    if (tls.fd >= 0) {
+        close(tls.fd);
+        tls.fd = -1;
+    }
+    tls.ctx.reset();
+}
+
+// Background reader for TLS 1.3 tickets: polls handed-over connections and runs
+// their post-handshake records through SSL_peek until a ticket shows up or the
+// deadline passes
+struct TicketRead {
+    PreflightTls tls;
+    std::chrono::steady_clock::time_point deadline;
+};
+
+struct TicketReader {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<TicketRead>> pending;
+    int wakefd = -1;
+    bool started = false;
+};
+
+static TicketReader& ticket_reader() {
+    // Never destroyed: the reader thread is detached
+    static TicketReader* r = new TicketReader();
+    return *r;
+}
+
+// true once the connection is done (ticket stored, nothing more to read or closed)
+static bool read_ticket(TicketRead& tr) {
+    const SslApi& ssl = native_api().ssl;
+    char byte;
+    t_capture = &tr.tls;
+    int r = ssl.SSL_peek(tr.tls.ssl, &byte, 1);
+    t_capture = nullptr;
+    if (tr.tls.fresh) return true;
+    // application data or a closed / failed connection: no ticket is coming
+    return r > 0 || ssl.SSL_get_error(tr.tls.ssl, r) != kErrorWantRead;
+}
+
+static void finish_read(TicketRead& tr) {
+    if (tr.tls.fresh) store_session(tr.tls);
+    else g_ticketMisses.fetch_add(1, std::memory_order_relaxed);
+    release(tr.tls);
+}
+
+static void ticket_loop() {
+    TicketReader& r = ticket_reader();
+    std::vector<struct pollfd> fds;
+    for (;;) {
+        int timeoutMs = -1;
+        fds.clear();
+        fds.push_back({r.wakefd, POLLIN, 0});
+        {
+            std::lock_guard<std::mutex> lock(r.mutex);
+            auto now = std::chrono::steady_clock::now();
+            for (auto& tr : r.pending) {
+                fds.push_back({tr->tls.fd, POLLIN, 0});
+                int64_t leftMs = std::chrono::duration_cast<std::chrono::milliseconds>(tr->deadline - now).count() + 1;
+                if (leftMs < 0) leftMs = 0;
+                if (timeoutMs < 0 || leftMs < timeoutMs) timeoutMs = (int)leftMs;
+            }
+        }
+        // without an eventfd (poll skips the -1 entry) new connections are only
+        // noticed on the next tick
+        if (r.wakefd < 0 && (timeoutMs < 0 || timeoutMs > 20)) timeoutMs = 20;
+        poll(fds.data(), fds.size(), timeoutMs);
+        if (r.wakefd >= 0 && (fds[0].revents & POLLIN)) {
+            uint64_t v;
+            (void)!read(r.wakefd, &v, sizeof(v));
+        }
+
+        std::lock_guard<std::mutex> lock(r.mutex);
+        auto now = std::chrono::steady_clock::now();
+        // entries are only appended by other threads, so the first fds.size() - 1 still
+        // line up with the poll set
+        size_t polled = fds.size() - 1;
+        size_t keep = 0;
+        for (size_t i = 0; i < r.pending.size(); i++) {
+            TicketRead& tr = *r.pending[i];
+            bool done = false;
+            if (i < polled && fds[i + 1].revents) done = read_ticket(tr);
+            if (!done && now >= tr.deadline) done = true;
+            if (done) {
+                finish_read(tr);
+                r.pending[i].reset();
+            } else {
+                r.pending[keep++] = std::move(r.pending[i]);
+            }
+        }
+        r.pending.resize(keep);
+    }
+}
+
+// Queues the connection for the reader; false when it is full or cannot start
+static bool hand_to_reader(PreflightTls& tls) {
+    int flags = fcntl(tls.fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(tls.fd, F_SETFL, flags | O_NONBLOCK) < 0) return false;
+    TicketReader& r = ticket_reader();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    if (r.pending.size() >= kMaxTicketReads) return false;
+    if (!r.started) {
+        r.wakefd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (r.wakefd < 0) LOGW("preflight: eventfd failed, ticket reader falls back to polling");
+        std::thread(ticket_loop).detach();
+        r.started = true;
+    }
+    auto tr = std::make_unique<TicketRead>();
+    int64_t waitUs = tls.handshakeUs * 2;
+    if (waitUs < kTicketWaitMinUs) waitUs = kTicketWaitMinUs;
+    if (waitUs > kTicketWaitMaxUs) waitUs = kTicketWaitMaxUs;
+    tr->deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(waitUs);
+    PreflightTls& to = tr->tls;
+    to.ssl = tls.ssl;
+    to.fd = tls.fd;
+    to.ctx = std::move(tls.ctx);
+    to.origin = std::move(tls.origin);
+    to.offered = tls.offered;
+    to.connected = tls.connected;
+    to.resumed = tls.resumed;
+    to.handshakeUs = tls.handshakeUs;
+    tls.ssl = nullptr;
+    tls.fd = -1;
+    r.pending.push_back(std::move(tr));
+    g_ticketReads.fetch_add(1, std::memory_order_relaxed);
+    if (r.wakefd >= 0) {
+        uint64_t one = 1;
+        (void)!write(r.wakefd, &one, sizeof(one));
+    }
+    return true;
+}
+
+void preflight_tls_end(PreflightTls& tls, bool keep) {
+    if (tls.ctx && tls.ctx->resumable) {
+        if (keep && tls.connected) {
+            // TLS 1.2 delivers the session during the handshake; TLS 1.3 sends tickets
+            // (fresh ones after a resumption too, they are meant to be single use) later
+            if (tls.fresh) store_session(tls);
+            else if (hand_to_reader(tls)) return;
+        } else if (tls.offered) {
+            // failed on a cached session (or its peer failed the pins): never offer it again
+            forget_session(tls);
+        }
+    }
+    release(tls);
+}
+
+PreflightCtxStats preflight_ctx_stats() {
+    PreflightCtxStats st{};
+    {
+        std::lock_guard<std::mutex> lock(g_ctxMutex);
+        st.contexts = g_contexts.size();
+        for (auto& kv : g_contexts) {
+            std::lock_guard<std::mutex> ctxLock(kv.second->mutex);
+            st.sessions += kv.second->sessions.size();
+        }
+    }
+    st.created = g_created.load(std::memory_order_relaxed);
+    st.offered = g_offered.load(std::memory_order_relaxed);
+    st.resumed = g_resumed.load(std::memory_order_relaxed);
+    st.captured = g_captured.load(std::memory_order_relaxed);
+    st.ticketReads = g_ticketReads.load(std::memory_order_relaxed);
+    st.ticketMisses = g_ticketMisses.load(std::memory_order_relaxed);
+    return st;
+}
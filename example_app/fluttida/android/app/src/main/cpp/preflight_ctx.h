@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Long-lived client SSL_CTX for the native pinning preflight, one per trust
+// configuration (insecure flag + CA bundle path, the same split curl uses).
+//
+// Building a context per request paid for TLS_client_method / SSL_CTX_new, never
+// loaded a CA store and could not resume, so every preflight was a cold full
+// handshake. A shared context is configured once:
+//  - the CA bundle is loaded once and the chain verified (unless insecure);
+//  - ALPN offers h2 and http/1.1, like curl's own handshake;
+//  - client session caching keeps the latest session per origin (host:port),
+//    offered on the next preflight so it can resume.
+// TLS 1.3 delivers session tickets after the handshake. Rather than holding up the
+// request, a finished preflight connection is handed to a background reader that
+// waits briefly for the ticket, caches it and closes the connection.
+// Resumed sessions keep the peer certificate, so the pin check still runs.
+
+struct PreflightContext;
+
+struct PreflightCtxStats {
+    size_t contexts;
+    uint64_t created;       // contexts built (one per trust configuration while cached)
+    size_t sessions;        // origins with a cached session
+    uint64_t offered;       // handshakes that offered a cached session
+    uint64_t resumed;       // ... that the server resumed
+    uint64_t captured;      // sessions stored after a handshake
+    uint64_t ticketReads;   // connections handed to the background ticket reader
+    uint64_t ticketMisses;  // ... that closed without a ticket
+};
+
+// One preflight handshake on the shared context. Not copyable; end() releases it.
+struct PreflightTls {
+    void* ssl = nullptr;
+    int fd = -1;            // owned once begin() succeeded
+    std::shared_ptr<PreflightContext> ctx;
+    std::string origin;
+    bool offered = false;
+    bool connected = false;
+    bool resumed = false;
+    int64_t handshakeUs = 0;
+    void* fresh = nullptr;  // session delivered by the new-session callback
+
+    PreflightTls() = default;
+    PreflightTls(const PreflightTls&) = delete;
+    PreflightTls& operator=(const PreflightTls&) = delete;
+    ~PreflightTls();
+};
+
+// Creates the SSL for host:port on fd (SNI set, cached session offered) and takes
+// ownership of fd. False (fd left to the caller) without NATIVE_CAP_PREFLIGHT or
+// when the context cannot be built.
+bool preflight_tls_begin(PreflightTls& tls, const std::string& caInfoPath, bool insecure,
+                         const std::string& host, int port, int fd);
+
+// SSL_connect on the blocking socket; true once the handshake (and chain
+// verification, when a CA store is loaded) succeeded.
+bool preflight_tls_connect(PreflightTls& tls);
+
+// Releases the connection. With keep, the session is cached for the origin; when
+// no ticket has arrived yet the connection goes to the background reader first.
+// keep = false (failed handshake or pin mismatch) also forgets a session that was
+// offered for the origin.
+void preflight_tls_end(PreflightTls& tls, bool keep);
+
+PreflightCtxStats preflight_ctx_stats();
@@ -0,0 +1,386 @@
+#include "session_store.h"
+
+#include "native_api.h"
+#include "native_log.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+constexpr size_t kMaxEntries = 64;
+constexpr size_t kMaxBytes = 256 * 1024;
+constexpr size_t kMaxSessionBytes = 16 * 1024;
+constexpr size_t kMaxKeyBytes = 4096;
+constexpr int64_t kMaxAgeSeconds = 24 * 3600;
+constexpr auto kWriteDelay = std::chrono::seconds(1);
+
+// SSL_CB_HANDSHAKE_START / SSL_CB_HANDSHAKE_DONE
+constexpr int kCbHandshakeStart = 0x10;
+constexpr int kCbHandshakeDone = 0x20;
+
+const char kMagic[8] = {'F', 'L', 'T', 'S', 'E', 'S', 'S', '1'};
+
+struct Entry {
+    std::vector<unsigned char> der;
+    int64_t expiry;         // unix seconds
+    uint64_t stamp;         // insertion order, oldest evicted first
+};
+
+struct Store {
+    std::mutex mutex;
+    std::condition_variable dirtyCv;
+    std::unordered_map<std::string, Entry> entries;
+    std::string path;
+    size_t bytes = 0;
+    uint64_t nextStamp = 1;
+    bool open = false;
+    bool dirty = false;
+    bool writerStarted = false;
+    uint64_t loaded = 0;
+    uint64_t captured = 0;
+    uint64_t offered = 0;
+    uint64_t resumed = 0;
+    uint64_t rejected = 0;
+    uint64_t expired = 0;
+    uint64_t evicted = 0;
+    uint64_t writes = 0;
+};
+
+Store& store() {
+    // Never destroyed: session callbacks may still run on curl threads at exit
+    static Store* s = new Store();
+    return *s;
+}
+
+// Per-connection state on curl's SSL_CTX (curl builds one SSL_CTX per connection)
+struct ConnState {
+    std::string key;
+    SSL_new_session_cb_t prevNewSession = nullptr;  // curl's own cache callback
+    SSL_info_cb_t prevInfo = nullptr;
+    bool started = false;   // first HANDSHAKE_START seen (renegotiation is left alone)
+    bool offered = false;
+    bool done = false;
+};
+
+void free_conn(void* /*parent*/, void* ptr, void* /*ad*/, int /*idx*/, long /*argl*/, void* /*argp*/) {
+    delete static_cast<ConnState*>(ptr);
+}
+
+int ex_index() {
+    static const int idx = [] {
+        if (!native_api().has(NATIVE_CAP_SESSION_STORE)) return -1;
+        int i = native_ssl_ctx_ex_new_index(free_conn);
+        if (i < 0) LOGE("session_store: SSL_CTX ex_data index allocation failed");
+        return i;
+    }();
+    return idx;
+}
+
+ConnState* conn_state(const void* ssl) {
+    int idx = ex_index();
+    if (idx < 0 || !ssl) return nullptr;
+    const SslApi& api = native_api().ssl;
+    void* ctx = api.SSL_get_SSL_CTX(ssl);
+    return ctx ? static_cast<ConnState*>(api.SSL_CTX_get_ex_data(ctx, idx)) : nullptr;
+}
+
+int64_t now_seconds() { return (int64_t)time(nullptr); }
+
+void remove_locked(Store& s, std::unordered_map<std::string, Entry>::iterator it) {
+    s.bytes -= it->second.der.size();
+    s.entries.erase(it);
+}
+
+// Drops expired entries, then the oldest ones until both bounds hold
+void trim_locked(Store& s, int64_t now) {
+    for (auto it = s.entries.begin(); it != s.entries.end();) {
+        if (it->second.expiry <= now) {
+            auto dead = it++;
+            remove_locked(s, dead);
+            s.expired++;
+        } else {
+            ++it;
+        }
+    }
+    while (s.entries.size() > kMaxEntries || s.bytes > kMaxBytes) {
+        auto oldest = s.entries.begin();
+        for (auto it = s.entries.begin(); it != s.entries.end(); ++it) {
+            if (it->second.stamp < oldest->second.stamp) oldest = it;
+        }
+        remove_locked(s, oldest);
+        s.evicted++;
+    }
+}
+
+void put_locked(Store& s, const std::string& key, std::vector<unsigned char> der, int64_t expiry) {
+    auto it = s.entries.find(key);
+    if (it != s.entries.end()) remove_locked(s, it);
+    s.bytes += der.size();
+    s.entries[key] = Entry{std::move(der), expiry, s.nextStamp++};
+    trim_locked(s, now_seconds());
+}
+
+void mark_dirty_locked(Store& s) {
+    if (!s.open) return;
+    s.dirty = true;
+    s.dirtyCv.notify_one();
+}
+
+template <typename T>
+void put_raw(std::string& out, T v) {
+    out.append(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+template <typename T>
+bool get_raw(const std::string& in, size_t& off, T* v) {
+    if (in.size() - off < sizeof(T)) return false;
+    memcpy(v, in.data() + off, sizeof(T));
+    off += sizeof(T);
+    return true;
+}
+
+// "FLTSESS1", u32 count, then per entry: u16 key length, key, i64 expiry, u32 DER length, DER
+// (host byte order: the file never leaves the device)
+bool write_file(const std::string& path, const std::string& data) {
+    std::string tmp = path + ".tmp";
+    FILE* f = fopen(tmp.c_str(), "wb");
+    if (!f) return false;
+    bool ok = fwrite(data.data(), 1, data.size(), f) == data.size();
+    ok = (fclose(f) == 0) && ok;
+    if (ok) ok = rename(tmp.c_str(), path.c_str()) == 0;
+    if (!ok) remove(tmp.c_str());
+    return ok;
+}
+
+void writer_loop() {
+    Store& s = store();
+    std::unique_lock<std::mutex> lock(s.mutex);
+    for (;;) {
+        s.dirtyCv.wait(lock, [&] { return s.dirty; });
+        // let a burst of new sessions (TLS 1.3 servers send several tickets) land first
+        lock.unlock();
+        std::this_thread::sleep_for(kWriteDelay);
+        lock.lock();
+        s.dirty = false;
+        trim_locked(s, now_seconds());
+        std::string data(kMagic, sizeof(kMagic));
+        put_raw<uint32_t>(data, (uint32_t)s.entries.size());
+        for (const auto& kv : s.entries) {
+            put_raw<uint16_t>(data, (uint16_t)kv.first.size());
+            data += kv.first;
+            put_raw<int64_t>(data, kv.second.expiry);
+            put_raw<uint32_t>(data, (uint32_t)kv.second.der.size());
+            data.append(reinterpret_cast<const char*>(kv.second.der.data()), kv.second.der.size());
+        }
+        std::string path = s.path;
+        lock.unlock();
+        bool ok = write_file(path, data);
+        lock.lock();
+        if (ok) s.writes++;
+        else LOGE("session_store: writing %s failed", path.c_str());
+    }
+}
+
+void load_file_locked(Store& s) {
+    FILE* f = fopen(s.path.c_str(), "rb");
+    if (!f) return;
+    std::string in;
+    char buf[16384];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0 && in.size() <= kMaxBytes * 2) in.append(buf, n);
+    fclose(f);
+    if (in.size() < sizeof(kMagic) || memcmp(in.data(), kMagic, sizeof(kMagic)) != 0) {
+        LOGW("session_store: ignoring %s (bad header)", s.path.c_str());
+        return;
+    }
+    size_t off = sizeof(kMagic);
+    uint32_t count = 0;
+    if (!get_raw(in, off, &count)) return;
+    int64_t now = now_seconds();
+    for (uint32_t i = 0; i < count; ++i) {
+        uint16_t keyLen;
+        int64_t expiry;
+        uint32_t derLen;
+        if (!get_raw(in, off, &keyLen) || in.size() - off < keyLen) break;
+        std::string key = in.substr(off, keyLen);
+        off += keyLen;
+        if (!get_raw(in, off, &expiry) || !get_raw(in, off, &derLen) || in.size() - off < derLen) break;
+        std::vector<unsigned char> der(in.begin() + off, in.begin() + off + derLen);
+        off += derLen;
+        if (expiry <= now) {
+            s.expired++;
+            continue;
+        }
+        if (derLen == 0 || derLen > kMaxSessionBytes) continue;
+        put_locked(s, key, std::move(der), expiry);
+        s.loaded++;
+    }
+}
+
+int on_new_session(void* ssl, void* session) {
+    ConnState* cs = conn_state(ssl);
+    if (!cs) return 0;
+    const SslApi& api = native_api().ssl;
+    bool resumable = !api.SSL_SESSION_is_resumable || api.SSL_SESSION_is_resumable(session);
+    if (resumable) {
+        int len = api.i2d_SSL_SESSION(session, nullptr);
+        if (len > 0 && (size_t)len <= kMaxSessionBytes) {
+            std::vector<unsigned char> der((size_t)len);
+            unsigned char* p = der.data();
+            if (api.i2d_SSL_SESSION(session, &p) == len) {
+                int64_t now = now_seconds();
+                int64_t expiry = (int64_t)api.SSL_SESSION_get_time(session) + (int64_t)api.SSL_SESSION_get_timeout(session);
+                if (expiry > now + kMaxAgeSeconds) expiry = now + kMaxAgeSeconds;
+                if (expiry > now) {
+                    Store& s = store();
+                    std::lock_guard<std::mutex> lock(s.mutex);
+                    put_locked(s, cs->key, std::move(der), expiry);
+                    s.captured++;
+                    mark_dirty_locked(s);
+                }
+            }
+        }
+    }
+    // curl's callback decides ownership of the session (1 = it kept a reference)
+    return cs->prevNewSession ? cs->prevNewSession(ssl, session) : 0;
+}
+
+void offer_session(void* ssl, ConnState* cs) {
+    const SslApi& api = native_api().ssl;
+    if (api.SSL_get_session(ssl)) return; // curl already resumes from its in-memory cache
+    std::vector<unsigned char> der;
+    {
+        Store& s = store();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        auto it = s.entries.find(cs->key);
+        if (it == s.entries.end()) return;
+        if (it->second.expiry <= now_seconds()) {
+            remove_locked(s, it);
+            s.expired++;
+            mark_dirty_locked(s);
+            return;
+        }
+        der = it->second.der;
+    }
+    const unsigned char* p = der.data();
+    void* session = api.d2i_SSL_SESSION(nullptr, &p, (long)der.size());
+    if (!session) return;
+    if (api.SSL_set_session(ssl, session) == 1) {
+        cs->offered = true;
+        std::lock_guard<std::mutex> lock(store().mutex);
+        store().offered++;
+    }
+    api.SSL_SESSION_free(session); // SSL_set_session took its own reference
+}
+
+void on_info(const void* ssl, int where, int ret) {
+    ConnState* cs = conn_state(ssl);
+    if (cs) {
+        if ((where & kCbHandshakeStart) && !cs->started) {
+            cs->started = true;
+            offer_session(const_cast<void*>(ssl), cs);
+        }
+        if ((where & kCbHandshakeDone) && cs->offered && !cs->done) {
+            cs->done = true;
+            bool reused = native_api().ssl.SSL_session_reused(ssl) == 1;
+            Store& s = store();
+            std::lock_guard<std::mutex> lock(s.mutex);
+            if (reused) {
+                s.resumed++;
+            } else {
+                // the server no longer accepts it; a fresh one arrives through on_new_session
+                s.rejected++;
+                auto it = s.entries.find(cs->key);
+                if (it != s.entries.end()) {
+                    remove_locked(s, it);
+                    mark_dirty_locked(s);
+                }
+            }
+        }
+        if (cs->prevInfo) cs->prevInfo(ssl, where, ret);
+    }
+}
+
+}  // namespace
+
+bool session_store_open(const std::string& path) {
+    if (ex_index() < 0) return false;
+    Store& s = store();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.path = path;
+    s.entries.clear();
+    s.bytes = 0;
+    s.open = true;
+    load_file_locked(s);
+    if (!s.writerStarted) {
+        s.writerStarted = true;
+        std::thread(writer_loop).detach();
+    }
+    LOGI("session_store: %s loaded %zu sessions", path.c_str(), s.entries.size());
+    return true;
+}
+
+bool session_store_enabled() {
+    Store& s = store();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return s.open;
+}
+
+bool session_store_attach(void* sslCtx, const std::string& key) {
+    int idx = ex_index();
+    if (idx < 0 || !sslCtx || key.size() > kMaxKeyBytes) return false;
+    const SslApi& api = native_api().ssl;
+    // one SSL_CTX per connection: a second attach only updates the key
+    auto* cs = static_cast<ConnState*>(api.SSL_CTX_get_ex_data(sslCtx, idx));
+    if (cs) {
+        cs->key = key;
+        return true;
+    }
+    cs = new ConnState();
+    cs->key = key;
+    cs->prevNewSession = api.SSL_CTX_sess_get_new_cb(sslCtx);
+    cs->prevInfo = api.SSL_CTX_get_info_callback(sslCtx);
+    if (api.SSL_CTX_set_ex_data(sslCtx, idx, cs) != 1) {
+        delete cs;
+        return false;
+    }
+    api.SSL_CTX_sess_set_new_cb(sslCtx, on_new_session);
+    api.SSL_CTX_set_info_callback(sslCtx, on_info);
+    return true;
+}
+
+void session_store_clear() {
+    Store& s = store();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.entries.clear();
+    s.bytes = 0;
+    mark_dirty_locked(s);
+}
+
+SessionStoreStats session_store_stats() {
+    Store& s = store();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    SessionStoreStats st{};
+    st.open = s.open;
+    st.entries = s.entries.size();
+    st.bytes = s.bytes;
+    st.loaded = s.loaded;
+    st.captured = s.captured;
+    st.offered = s.offered;
+    st.resumed = s.resumed;
+    st.rejected = s.rejected;
+    st.expired = s.expired;
+    st.evicted = s.evicted;
+    st.writes = s.writes;
+    return st;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Persistent client TLS session cache, so the first request after an app start can
+// resume instead of doing a full handshake.
+//
+// curl's shared session cache (curl_share) only lives as long as the process. This
+// store hooks curl's per-connection SSL_CTX (from CURLOPT_SSL_CTX_FUNCTION):
+//  - OpenSSL's new-session callback serializes each session (i2d_SSL_SESSION) under
+//    the request's trust key (scheme, host, port, CA, pins, technique; the easy pool
+//    key), chaining to curl's own callback;
+//  - the info callback offers a stored session (SSL_set_session) at handshake start
+//    when curl has none in memory, and records whether the server resumed it.
+// Sessions are only captured from handshakes that passed verification (and pinning,
+// since the key includes the pins). A background thread writes the store to an
+// app-private file (write + rename) a moment after it changes; open() reloads it.
+// Entries expire with the session lifetime (capped at one day) and the store is
+// bounded by entry count and total bytes.
+
+struct SessionStoreStats {
+    bool open;
+    size_t entries;
+    size_t bytes;           // serialized session bytes held
+    uint64_t loaded;        // entries read from the file at open
+    uint64_t captured;      // new sessions stored
+    uint64_t offered;       // stored sessions handed to a handshake
+    uint64_t resumed;       // ... that the server accepted (abbreviated handshake)
+    uint64_t rejected;      // ... that ended in a full handshake (entry dropped)
+    uint64_t expired;
+    uint64_t evicted;       // dropped by the count / byte bounds
+    uint64_t writes;        // file rewrites
+};
+
+// Loads path (a missing file is an empty store) and starts persisting to it. False
+// when the TLS library lacks the API (NATIVE_CAP_SESSION_STORE). Reopening switches files.
+bool session_store_open(const std::string& path);
+
+bool session_store_enabled();
+
+// Installs the capture / offer hooks on a connection's SSL_CTX for key
+bool session_store_attach(void* sslCtx, const std::string& key);
+
+// Drops every entry and rewrites the file
+void session_store_clear();
+
+SessionStoreStats session_store_stats();
@@ -0,0 +1,225 @@
+// Host stress test for per-connection pin checks on curl's own TLS connections.
+//
+// Many threads hit several local TLS servers at once, each request pinned either to
+// the server it talks to or, for every third request, to another server's
+// certificate. Requests alternate between the sslctx technique (pin_verify_install on
+// curl's SSL_CTX) and the handshake technique (pin_verify_peer from the share probe),
+// and between certificate and SPKI pins, so the app's pin_verify code is what runs.
+// A request must succeed exactly when its pins match: the pin context must never
+// leak between concurrent connections, and a pinned request must never ride a
+// connection or TLS session negotiated under other pins.
+//
+// Servers (one self-signed CN=localhost certificate each, concatenated into the bundle):
+//   for i in 0 1 2 3; do
+//     openssl req -x509 -newkey rsa:2048 -nodes -subj /CN=localhost -keyout k$i.pem -out c$i.pem
+//     openssl s_server -quiet -www -accept 4430$i -cert c$i.pem -key k$i.pem &
+//   done
+//   cat c?.pem > bundle.pem
+//   ./pin_stress -t 16 -n 50 bundle.pem 44300 44301 44302 44303
+//
+// Exits non-zero when a matching request failed or a mismatching one got through.
+
+#include "curl_share.h"
+#include "native_api.h"
+#include "pin_matcher.h"
+#include "pin_verify.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <curl/curl.h>
+
+namespace {
+
+using Pins = std::shared_ptr<const PinMatcher>;
+
+// What one request checks, and how
+struct PinCheck {
+    Pins pins;
+    bool sslctx = false;    // sslctx technique, otherwise handshake
+};
+
+std::string base64_32(const unsigned char* d) {
+    static const char kTable[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    unsigned v = 0;
+    int bits = -6;
+    for (int i = 0; i < 32; ++i) {
+        v = (v << 8) + d[i];
+        bits += 8;
+        while (bits >= 0) {
+            out += kTable[(v >> bits) & 63];
+            bits -= 6;
+        }
+    }
+    if (bits > -6) out += kTable[((v << 8) >> (bits + 8)) & 63];
+    while (out.size() % 4) out += '=';
+    return out;
+}
+
+// Learning pass: "sha256/..." pins of the leaf curl negotiated (cert DER and SPKI)
+struct Learned {
+    std::string certPin;
+    std::string spkiPin;
+};
+
+bool learn_pins(void* ssl, void* data) {
+    const NativeApi& api = native_api();
+    auto* out = (Learned*)data;
+    void* peer = ssl ? api.ssl.SSL_get_peer_certificate(ssl) : nullptr;
+    if (!peer) return false;
+    unsigned char d[32];
+    unsigned char* der = nullptr;
+    int len = api.crypto.i2d_X509(peer, &der);
+    if (len > 0 && der) {
+        api.crypto.SHA256(der, (size_t)len, d);
+        free(der);
+        out->certPin = "sha256/" + base64_32(d);
+    }
+    if (void* pkey = api.crypto.X509_get_pubkey(peer)) {
+        der = nullptr;
+        len = api.crypto.i2d_PUBKEY(pkey, &der);
+        if (len > 0 && der) {
+            api.crypto.SHA256(der, (size_t)len, d);
+            free(der);
+            out->spkiPin = "sha256/" + base64_32(d);
+        }
+        api.crypto.EVP_PKEY_free(pkey);
+    }
+    api.crypto.X509_free(peer);
+    return !out->certPin.empty() && !out->spkiPin.empty();
+}
+
+// CURLOPT_SSL_CTX_FUNCTION, as native_http's ssl_ctx_callback_stub does for sslctx pins
+CURLcode ssl_ctx_function(void*, void* sslCtx, void* userp) {
+    return (CURLcode)pin_verify_install(sslCtx, ((const PinCheck*)userp)->pins);
+}
+
+// ShareProbe::tlsCheck, as native_http's handshake_pin_check
+bool handshake_check(void* ssl, void* data) {
+    return pin_verify_peer(ssl, *((const PinCheck*)data)->pins, "Handshake");
+}
+
+size_t discard(char*, size_t size, size_t nmemb, void*) {
+    return size * nmemb;
+}
+
+// One request against localhost:port. With check == nullptr the probe learns the
+// server's pins into *learned instead.
+int fetch(const std::string& caBundle, int port, const PinCheck* check, const std::string& isolationKey,
+          Learned* learned = nullptr) {
+    const CurlApi& curlApi = native_api().curl;
+    void* curl = curlApi.easy_init();
+    if (!curl) return CURLE_FAILED_INIT;
+    std::string url = "https://localhost:" + std::to_string(port) + "/";
+    curlApi.easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curlApi.easy_setopt(curl, CURLOPT_CAINFO, caBundle.c_str());
+    curlApi.easy_setopt(curl, CURLOPT_WRITEFUNCTION, discard);
+    curlApi.easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    ShareProbe probe;
+    if (check && check->sslctx) {
+        curlApi.easy_setopt(curl, CURLOPT_SSL_CTX_FUNCTION, ssl_ctx_function);
+        curlApi.easy_setopt(curl, CURLOPT_SSL_CTX_DATA, (void*)check);
+    } else if (check) {
+        probe.tlsCheck = handshake_check;
+        probe.tlsCheckData = (void*)check;
+    } else {
+        probe.tlsCheck = learn_pins;
+        probe.tlsCheckData = learned;
+    }
+    if (!curl_share_attach(curl, &probe, isolationKey)) {
+        curlApi.easy_cleanup(curl);
+        return CURLE_FAILED_INIT;
+    }
+    int rc = curlApi.easy_perform(curl);
+    curl_share_record(curl, &probe);
+    curlApi.easy_cleanup(curl);
+    return rc;
+}
+
+void usage(const char* argv0) {
+    fprintf(stderr, "usage: %s [-t threads] [-n iterations] CA_BUNDLE PORT PORT [PORT...]\n", argv0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int threads = 16;
+    int iterations = 50;
+    int argi = 1;
+    for (; argi + 1 < argc && argv[argi][0] == '-'; argi += 2) {
+        if (!strcmp(argv[argi], "-t")) threads = atoi(argv[argi + 1]);
+        else if (!strcmp(argv[argi], "-n")) iterations = atoi(argv[argi + 1]);
+        else break;
+    }
+    if (argc - argi < 3 || threads <= 0 || iterations <= 0) {
+        usage(argv[0]);
+        return 2;
+    }
+    std::string caBundle = argv[argi++];
+    std::vector<int> ports;
+    for (; argi < argc; ++argi) ports.push_back(atoi(argv[argi]));
+
+    const NativeApi& api = native_api();
+    uint32_t need = NATIVE_CAP_CURL | NATIVE_CAP_SSLCTX | NATIVE_CAP_VERIFY_CB | NATIVE_CAP_SSLCTX_DATA |
+                    NATIVE_CAP_PEER_PIN | NATIVE_CAP_SHARE;
+    if (!api.has(need)) {
+        fprintf(stderr, "libcurl/OpenSSL lacks the pinning symbols (caps=0x%x)\n", api.caps);
+        return 2;
+    }
+
+    // Learn each server's pins with a plain verified request on the global share
+    std::vector<Pins> certPins;
+    std::vector<Pins> spkiPins;
+    for (int port : ports) {
+        Learned l;
+        int rc = fetch(caBundle, port, nullptr, std::string(), &l);
+        if (rc != CURLE_OK) {
+            fprintf(stderr, "port %d: learning request failed (rc=%d)\n", port, rc);
+            return 2;
+        }
+        certPins.push_back(pin_matcher_compile(l.certPin, std::string()));
+        spkiPins.push_back(pin_matcher_compile(std::string(), l.spkiPin));
+    }
+
+    std::atomic<int> matchOk{0}, matchFailed{0}, mismatchOk{0}, mismatchRejected{0};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            for (int i = 0; i < iterations; ++i) {
+                size_t srv = (size_t)(t + i) % ports.size();
+                bool wrong = (t * 7 + i) % 3 == 0;
+                size_t pinned = wrong ? (srv + 1) % ports.size() : srv;
+                PinCheck check;
+                check.sslctx = i % 2 == 0;
+                bool spki = t % 2 == 1;
+                check.pins = spki ? spkiPins[pinned] : certPins[pinned];
+                // native_http isolates pinned transfers per pin configuration and technique
+                std::string key = std::to_string(pinned) + (spki ? "|spki|" : "|cert|") +
+                                  (check.sslctx ? "sslctx" : "handshake");
+                int rc = fetch(caBundle, ports[srv], &check, key);
+                if (wrong) (rc == CURLE_OK ? mismatchOk : mismatchRejected)++;
+                else if (rc == CURLE_OK) matchOk++;
+                else {
+                    matchFailed++;
+                    fprintf(stderr, "port %d: matching pins failed (rc=%d)\n", ports[srv], rc);
+                }
+            }
+        });
+    }
+    for (std::thread& w : workers) w.join();
+
+    ShareStats st = curl_share_stats();
+    printf("matching pins: %d ok / %d failed; other server's pins: %d ok / %d rejected\n",
+           matchOk.load(), matchFailed.load(), mismatchOk.load(), mismatchRejected.load());
+    printf("shares: %zu isolated; connections reused=%llu new=%llu; tls resumed=%llu full=%llu\n",
+           st.isolated, (unsigned long long)st.connReused, (unsigned long long)st.connNew,
+           (unsigned long long)st.tlsResumed, (unsigned long long)st.tlsFull);
+    return matchFailed == 0 && mismatchOk == 0 ? 0 : 1;
+}
@@ -5,7 +5,11 @@ package com.example.fluttida
 import android.os.Bundle
 import io.flutter.embedding.android.FlutterActivity
 import io.flutter.embedding.engine.FlutterEngine
+import io.flutter.plugin.common.BasicMessageChannel
+import io.flutter.plugin.common.BinaryCodec
+import io.flutter.plugin.common.EventChannel
 import io.flutter.plugin.common.MethodChannel
+import org.json.JSONObject
 import java.io.OutputStreamWriter
 import java.net.HttpURLConnection
 import java.net.URL
@@ -26,6 +30,7 @@ import org.chromium.net.CronetException
 import java.io.ByteArrayOutputStream
 import java.nio.ByteBuffer
 import java.util.concurrent.Executors
+import java.util.concurrent.FutureTask
 import android.os.Handler
 import android.os.Looper
 import java.io.File
@@ -35,15 +40,25 @@ import java.util.Date
 
 class MainActivity : FlutterActivity() {
 	private val CHANNEL = "fluttida/network"
+	private val BODY_CHANNEL = "fluttida/native_body"
+	private val STREAM_CHANNEL = "fluttida/native_stream"
+
+	// Token of the native curl stream currently feeding STREAM_CHANNEL (0 = none)
+	@Volatile
+	private var nativeStreamToken: Long = 0
 
 	companion object {
 		@Volatile
 		private var instance: MainActivity? = null
 
-		// Called from native C++ (JNI) to surface logs into Flutter UI
+		// Called from the native log drainer thread (JNI) with a batch of log lines for the
+		// Flutter UI; dropped counts lines lost to a full native ring since the last batch
 		@JvmStatic
-		fun sendLogToFlutter(msg: String) {
-			instance?.sendLogToFlutterInstance(msg) ?: android.util.Log.d("FluttidaNativeCurl", msg)
+		fun sendLogBatchToFlutter(msgs: Array<String?>, dropped: Long) {
+			val lines = msgs.filterNotNull().toMutableList()
+			if (dropped > 0) lines.add("[NativeCurl] $dropped log lines dropped (native log buffer full)")
+			instance?.sendLogBatchToFlutterInstance(lines)
+				?: lines.forEach { android.util.Log.d("FluttidaNativeCurl", it) }
 		}
 
 		@JvmStatic
@@ -111,9 +126,19 @@ class MainActivity : FlutterActivity() {
 	@Volatile
 	private var techCronet: String? = null
 
+	// Native curl HTTP/2 mode (multiplexes concurrent requests to one origin)
+	@Volatile
+	private var nativeCurlHttp2: Boolean = false
+
+	// Bundled CA path, resolved once off the main thread (nativeCurlRequest runs on it);
+	// a request only waits for it if it arrives before the copy has finished
+	private val caBundlePath = FutureTask { ensureCaBundle() }
+
 	override fun onCreate(savedInstanceState: Bundle?) {
+		Thread(caBundlePath).start()
 		super.onCreate(savedInstanceState)
 		instance = this
+		NativeHttp.sessionStoreOpen(File(filesDir, "native_tls_sessions.bin").path)
 	}
 
 	override fun onDestroy() {
@@ -124,6 +149,9 @@ class MainActivity : FlutterActivity() {
 	override fun configureFlutterEngine(flutterEngine: FlutterEngine) {
 		super.configureFlutterEngine(flutterEngine)
 
+		setupNativeBodyChannel(flutterEngine)
+		setupNativeStreamChannel(flutterEngine)
+
 		MethodChannel(flutterEngine.dartExecutor.binaryMessenger, CHANNEL).setMethodCallHandler { call, result ->
 			when (call.method) {
 				"setGlobalPinningConfig" -> {
@@ -148,6 +176,17 @@ class MainActivity : FlutterActivity() {
 					}
 					result.success(null)
 				}
+				"setNativeCurlConfig" -> {
+					val args = call.arguments as? Map<*, *>
+					(args?.get("http2") as? Boolean)?.let { nativeCurlHttp2 = it }
+					(args?.get("http2MaxStreams") as? Number)?.let { NativeHttp.setHttp2MaxStreams(it.toInt()) }
+					val dnsCache = args?.get("dnsCache") as? Boolean
+					val dnsTtl = (args?.get("dnsTtlSeconds") as? Number)?.toInt()
+					if (dnsCache != null || dnsTtl != null) NativeHttp.dnsConfigure(dnsCache ?: true, dnsTtl ?: 0)
+					(args?.get("logLevel") as? String)?.let { NativeHttp.setLogLevel(it) }
+					if (args?.get("clearTlsSessions") == true) NativeHttp.sessionStoreClear()
+					result.success(null)
+				}
 				"isCronetPinningSupported" -> {
 					// Cronet pinning is now supported
 					result.success(true)
@@ -173,53 +212,171 @@ class MainActivity : FlutterActivity() {
 				}
 				"androidNativeCurl" -> {
 					val args = call.arguments as? Map<*, *>
+					// No per-call thread: the request is queued on the native curl_multi engine
+					val req = nativeCurlRequest(args)
+					NativeHttp.submit(req) { map ->
+						Handler(Looper.getMainLooper()).post { result.success(map) }
+					}
+				}
+				"androidNativeCurlBatch" -> {
+					val list = call.arguments as? List<*>
+					val requests = list.orEmpty().map { nativeCurlRequest(it as? Map<*, *>) }
+					// One thread and one JNI crossing for the whole batch; native code runs them concurrently
 					Thread {
-						val url = (args?.get("url") as? String) ?: ""
-						val method = (args?.get("method") as? String) ?: "GET"
-						val headers = mutableMapOf<String, String>()
-						(args?.get("headers") as? Map<*, *>)?.forEach { (k, v) ->
-							if (k is String && v is String) headers[k] = v
-						}
-						val body = args?.get("body") as? String
-						val timeoutMs = (args?.get("timeoutMs") as? Number)?.toInt() ?: 20000
-
-						// If a bundled CA exists as asset, copy once to cache/files and pass path via pseudo-header
-						try {
-							val caPath = ensureCaBundle()
-							if (caPath != null && headers.keys.none { it.equals("X-Curl-CaInfo", ignoreCase = true) }) {
-								headers["X-Curl-CaInfo"] = caPath
-							}
-						} catch (_: Throwable) { }
-
-						// Pass global pinning to native curl via pseudo-headers according to technique
-						try {
-							val effTech = effectiveNativeCurlTech()
-							if (globalPinningEnabled && effTech != "none") {
-								if (globalPinningMode == "publicKey" && globalSpkiPins.isNotEmpty() && headers.keys.none { it.equals("X-Curl-SpkiPins", ignoreCase = true) }) {
-									headers["X-Curl-SpkiPins"] = globalSpkiPins.joinToString(",")
-								} else if (globalPinningMode == "certHash" && globalCertPins.isNotEmpty() && headers.keys.none { it.equals("X-Curl-CertPins", ignoreCase = true) }) {
-									headers["X-Curl-CertPins"] = globalCertPins.joinToString(",")
-								}
-								// convey technique to native curl: preflight | sslctx | both
-								val techHeader = when (effTech) {
-									"curlPreflight" -> "preflight"
-									"curlSslCtx" -> "sslctx"
-									"curlBoth", "auto" -> "both"
-									else -> null
-								}
-								if (techHeader != null) headers["X-Curl-Technique"] = techHeader
-							}
-						} catch (_: Throwable) { }
-
-						val map = NativeHttp.perform(method, url, headers, body, timeoutMs)
-						result.success(map)
+						val results = NativeHttp.batch(requests)
+						Handler(Looper.getMainLooper()).post { result.success(results) }
 					}.start()
 				}
+				"androidNativeCurlStreamAck" -> {
+					val bytes = ((call.arguments as? Map<*, *>)?.get("bytes") as? Number)?.toLong() ?: 0L
+					val token = nativeStreamToken
+					if (token != 0L && bytes > 0) NativeHttp.streamAck(token, bytes)
+					result.success(null)
+				}
+				"androidNativeCurlDnsPrefetch" -> {
+					val hosts = (call.arguments as? List<*>)?.filterIsInstance<String>().orEmpty()
+					NativeHttp.dnsPrefetch(hosts)
+					result.success(null)
+				}
+				"androidNativeCurlStats" -> {
+					result.success(NativeHttp.stats())
+				}
 				else -> result.notImplemented()
 			}
 		}
 	}
 
+	// Binary native curl requests: the message is the UTF-8 JSON args, the reply is the native
+	// body block (cpp/body_buffer.h) passed through without converting the body to a String
+	private fun setupNativeBodyChannel(flutterEngine: FlutterEngine) {
+		BasicMessageChannel(flutterEngine.dartExecutor.binaryMessenger, BODY_CHANNEL, BinaryCodec.INSTANCE).setMessageHandler { message, reply ->
+			val args = try {
+				val bytes = ByteArray(message?.remaining() ?: 0)
+				message?.get(bytes)
+				val o = JSONObject(String(bytes, Charsets.UTF_8))
+				val headers = o.optJSONObject("headers")
+				mapOf(
+					"url" to o.optString("url"),
+					"method" to o.optString("method", "GET"),
+					"headers" to headers?.keys()?.asSequence()?.associateWith { headers.optString(it) },
+					"body" to if (o.isNull("body")) null else o.optString("body"),
+					"timeoutMs" to o.optInt("timeoutMs", 20000),
+				)
+			} catch (_: Throwable) {
+				null
+			}
+			if (args == null) {
+				// Unparseable request: nothing to send, Dart reports "no response"
+				reply.reply(null)
+				return@setMessageHandler
+			}
+			NativeHttp.submitBody(nativeCurlRequest(args)) { buffer ->
+				Handler(Looper.getMainLooper()).post {
+					if (buffer == null) {
+						reply.reply(null)
+					} else {
+						// The engine reads position() bytes and copies them before reply() returns
+						buffer.position(buffer.limit())
+						reply.reply(buffer)
+						NativeHttp.freeBody(buffer)
+					}
+				}
+			}
+		}
+	}
+
+	// Streaming native curl requests: listen(args) starts one, events are body chunks (ByteArray)
+	// followed by the result map, then end of stream. Dart acknowledges consumed bytes via
+	// androidNativeCurlStreamAck, which is what lets the native side pause/resume the transfer.
+	private fun setupNativeStreamChannel(flutterEngine: FlutterEngine) {
+		EventChannel(flutterEngine.dartExecutor.binaryMessenger, STREAM_CHANNEL).setStreamHandler(object : EventChannel.StreamHandler {
+			override fun onListen(arguments: Any?, events: EventChannel.EventSink?) {
+				val args = arguments as? Map<*, *>
+				val windowBytes = (args?.get("windowBytes") as? Number)?.toInt() ?: 0
+				val main = Handler(Looper.getMainLooper())
+				var token = 0L
+				token = NativeHttp.stream(nativeCurlRequest(args), windowBytes,
+					onChunk = { chunk -> main.post { events?.success(chunk) } },
+					onDone = { map ->
+						main.post {
+							if (nativeStreamToken == token) nativeStreamToken = 0
+							events?.success(map)
+							events?.endOfStream()
+						}
+					})
+				nativeStreamToken = token
+			}
+
+			override fun onCancel(arguments: Any?) {
+				val token = nativeStreamToken
+				nativeStreamToken = 0
+				if (token != 0L) NativeHttp.streamCancel(token)
+			}
+		})
+	}
+
+	// Builds the native curl request from channel args: headers as flat pairs, CA bundle,
+	// global pinning and HTTP/2 as typed NativeHttp.Options. X-Curl-* pseudo headers from the
+	// caller are lifted into the Options (never sent); CaInfo, pins and Http2 given that way
+	// win over the bundled CA, global pinning and the global HTTP/2 switch.
+	private fun nativeCurlRequest(args: Map<*, *>?): NativeHttp.Request {
+		val url = (args?.get("url") as? String) ?: ""
+		val method = (args?.get("method") as? String) ?: "GET"
+		val headerPairs = ArrayList<String>()
+		val pseudo = HashMap<String, String>()
+		(args?.get("headers") as? Map<*, *>)?.forEach { (k, v) ->
+			if (k is String && v is String) {
+				if (k.startsWith("X-Curl-", ignoreCase = true)) {
+					pseudo[k.lowercase()] = v
+				} else {
+					headerPairs.add(k)
+					headerPairs.add(v)
+				}
+			}
+		}
+		fun truthy(v: String?) = v == "1" || v.equals("true", ignoreCase = true)
+		fun pinList(v: String?) = v?.split(',')?.map { it.trim() }?.filter { it.isNotEmpty() }?.toTypedArray()
+		// Uint8List bodies arrive as ByteArray and are sent as-is by the native side
+		val body: Any? = args?.get("body")?.takeIf { it is String || it is ByteArray }
+		val timeoutMs = (args?.get("timeoutMs") as? Number)?.toInt() ?: 20000
+		// Only these response headers are materialized (native side drops the rest)
+		val responseHeaders = (args?.get("responseHeaders") as? List<*>)?.filterIsInstance<String>()?.toTypedArray()
+
+		// If a bundled CA exists as asset, pass the path of its cached copy
+		val caPath = pseudo["x-curl-cainfo"] ?: try { caBundlePath.get() } catch (_: Throwable) { null }
+
+		// Caller pins first, otherwise global pinning according to technique
+		var spkiPins: Array<String>? = pinList(pseudo["x-curl-spkipins"])
+		var certPins: Array<String>? = pinList(pseudo["x-curl-certpins"])
+		var technique: String? = pseudo["x-curl-technique"]
+		val effTech = effectiveNativeCurlTech()
+		if (globalPinningEnabled && effTech != "none") {
+			if (globalPinningMode == "publicKey" && globalSpkiPins.isNotEmpty()) {
+				if (spkiPins == null) spkiPins = globalSpkiPins.toTypedArray()
+			} else if (globalPinningMode == "certHash" && globalCertPins.isNotEmpty()) {
+				if (certPins == null) certPins = globalCertPins.toTypedArray()
+			}
+			// technique for native curl: preflight | sslctx | both | handshake
+			technique = when (effTech) {
+				"curlPreflight" -> "preflight"
+				"curlSslCtx" -> "sslctx"
+				"curlHandshake" -> "handshake"
+				"curlBoth", "auto" -> "both"
+				else -> technique
+			}
+		}
+
+		val options = NativeHttp.Options(
+			insecure = truthy(pseudo["x-curl-insecure"]),
+			caInfoPath = caPath,
+			spkiPins = spkiPins,
+			certPins = certPins,
+			technique = technique,
+			http2 = pseudo["x-curl-http2"]?.let { truthy(it) } ?: nativeCurlHttp2
+		)
+		return NativeHttp.Request(method, url, null, body, timeoutMs, headerPairs.toTypedArray(), options, responseHeaders)
+	}
+
 	// Normalize a pin string by removing optional "sha256/" prefix and all whitespace
 	private fun normalizePin(pin: String): String {
 		var p = pin.replace("\\s".toRegex(), "")
@@ -312,6 +469,19 @@ class MainActivity : FlutterActivity() {
 		} catch (_: Throwable) {}
 	}
 
+	// One main-thread hop and one channel message for a whole native log batch
+	private fun sendLogBatchToFlutterInstance(lines: List<String>) {
+		if (lines.isEmpty()) return
+		try {
+			Handler(Looper.getMainLooper()).post {
+				MethodChannel(
+					flutterEngine?.dartExecutor?.binaryMessenger ?: return@post,
+					CHANNEL
+				).invokeMethod("logBatch", mapOf("messages" to lines))
+			}
+		} catch (_: Throwable) {}
+	}
+
 	private fun getCronetEngine(host: String?): CronetEngine {
 		if (cronetEngine == null || cronetPinnedHost != host) {
 			synchronized(this) {
@@ -1,6 +1,6 @@
 package com.example.fluttida
 
-import org.json.JSONObject
+import java.nio.ByteBuffer
 
 object NativeHttp {
     init {
@@ -11,6 +11,69 @@ object NativeHttp {
         }
     }
 
+    // Filled field by field from native code (cached class, no-arg constructor)
+    class Result {
+        @JvmField var status: Int = -1          // HTTP status, -1 when there is no response
+        @JvmField var body: ByteArray? = null
+        @JvmField var durationMs: Int = 0
+        @JvmField var errorCode: Int = 0        // CURLcode, or -1 for setup/pinning failures
+        @JvmField var error: String? = null
+        @JvmField var httpVersion: String? = null
+        @JvmField var headers: Array<String>? = null // [name, value, ...] for Request.responseHeaders, names lowercase
+        @JvmField var timing: LongArray? = null     // see TIMING_KEYS
+    }
+
+    // Order of Result.timing (TransferTiming in native_http.cpp). Times are microseconds since
+    // the transfer started (cumulative, as libcurl reports them); pinCheckUs is the preflight.
+    private val TIMING_KEYS = arrayOf(
+        "nameLookupUs", "connectUs", "appConnectUs", "preTransferUs", "startTransferUs",
+        "totalUs", "pinCheckUs", "uploadBytes", "downloadBytes", "numConnects", "tlsResumed"
+    )
+
+    // Invoked from the native engine thread when a submitted request finishes
+    fun interface Callback {
+        fun onComplete(id: Long, result: Result?)
+    }
+
+    // Receives the native body block of nativeSubmitBody (layout in cpp/body_buffer.h).
+    // The buffer wraps native memory: hand it to freeBody() once it has been passed on.
+    fun interface BodyCallback {
+        fun onBody(id: Long, buffer: ByteBuffer?)
+    }
+
+    // Streaming delivery: onChunk runs on the engine thread for every body chunk; acknowledge
+    // consumed bytes with streamAck() or the transfer pauses once the window is full
+    interface StreamCallback {
+        fun onChunk(chunk: ByteArray)
+        fun onComplete(result: Result?)
+    }
+
+    // Per-request TLS/protocol options; typed replacement for the X-Curl-* pseudo headers
+    class Options(
+        @JvmField val insecure: Boolean = false,
+        @JvmField val caInfoPath: String? = null,
+        @JvmField val spkiPins: Array<String>? = null,
+        @JvmField val certPins: Array<String>? = null,
+        @JvmField val technique: String? = null, // preflight | sslctx | both | handshake
+        @JvmField val http2: Boolean = false
+    )
+
+    // Request descriptor for the typed entry points and nativeHttpBatch (fields are read
+    // directly by native code). body may be a String, ByteArray, direct ByteBuffer (the
+    // bytes between position and limit are sent; the buffer is not consumed) or File. headerPairs is a flat [name, value, name, value, ...] array
+    // sent as-is; the headers Map is still honoured (including pseudo headers) when set.
+    // responseHeaders lists the response header names to return in Result.headers ("*" = all).
+    class Request(
+        @JvmField val method: String,
+        @JvmField val url: String,
+        @JvmField val headers: Map<String, String>?,
+        @JvmField val body: Any?,
+        @JvmField val timeoutMs: Int,
+        @JvmField val headerPairs: Array<String>? = null,
+        @JvmField val options: Options? = null,
+        @JvmField val responseHeaders: Array<String>? = null
+    )
+
     external fun nativeHttpRequest(
         method: String,
         url: String,
@@ -19,23 +82,254 @@ object NativeHttp {
         timeoutMs: Int
     ): String
 
-    fun perform(method: String, url: String, headers: Map<String,String>?, body: String?, timeoutMs: Int): Map<String, Any?> {
-        return try {
-            val json = nativeHttpRequest(method, url, headers, body, timeoutMs)
-            val o = JSONObject(json)
-            mapOf(
-                "status" to if (o.has("status") && !o.isNull("status")) o.getInt("status") else null,
-                "body" to o.optString("body"),
-                "durationMs" to o.optInt("durationMs"),
-                "error" to if (o.has("error") && !o.isNull("error")) o.getString("error") else null,
-            )
-        } catch (t: Throwable) {
-            mapOf(
-                "status" to null,
-                "body" to "",
-                "durationMs" to 0,
-                "error" to ("native error: " + t.toString()),
-            )
+    external fun nativePerform(
+        method: String,
+        url: String,
+        headers: Map<String, String>?,
+        body: Any?,
+        timeoutMs: Int
+    ): Result?
+
+    external fun nativeSubmit(
+        method: String,
+        url: String,
+        headers: Map<String, String>?,
+        body: Any?,
+        timeoutMs: Int,
+        callback: Callback
+    ): Long
+
+    external fun nativeExecute(request: Request): Result?
+
+    external fun nativeSubmitRequest(request: Request, callback: Callback): Long
+
+    external fun nativeSubmitBody(request: Request, callback: BodyCallback): Long
+
+    external fun nativeFreeBody(buffer: ByteBuffer)
+
+    external fun nativeStreamSubmit(request: Request, windowBytes: Int, callback: StreamCallback): Long
+
+    external fun nativeStreamAck(token: Long, bytes: Long)
+
+    external fun nativeStreamCancel(token: Long)
+
+    external fun nativeHttpBatch(requests: Array<Request>): Array<Result?>?
+
+    external fun nativeHttpStats(): String
+
+    external fun nativeSetHttp2MaxStreams(maxStreams: Int)
+
+    external fun nativeSetLogLevel(level: Int)
+
+    external fun nativeSessionStoreOpen(path: String): Boolean
+
+    external fun nativeSessionStoreClear()
+
+    external fun nativeDnsPrefetch(hosts: Array<String>)
+
+    external fun nativeDnsConfigure(enabled: Boolean, ttlSeconds: Int)
+
+    fun perform(method: String, url: String, headers: Map<String,String>?, body: Any?, timeoutMs: Int): Map<String, Any?> {
+        return try {
+            toMap(nativePerform(method, url, headers, body, timeoutMs))
+        } catch (t: Throwable) {
+            errorResult(t)
+        }
+    }
+
+    // Non-blocking variant: runs on the native curl_multi engine, onResult is called on an engine thread
+    fun submit(method: String, url: String, headers: Map<String,String>?, body: Any?, timeoutMs: Int, onResult: (Map<String, Any?>) -> Unit): Long {
+        return try {
+            nativeSubmit(method, url, headers, body, timeoutMs) { _, result ->
+                onResult(toMap(result))
+            }
+        } catch (t: Throwable) {
+            onResult(errorResult(t))
+            0L
+        }
+    }
+
+    fun execute(req: Request): Map<String, Any?> {
+        return try {
+            toMap(nativeExecute(req))
+        } catch (t: Throwable) {
+            errorResult(t)
+        }
+    }
+
+    // Typed variant of submit (headerPairs/options instead of a Map with pseudo headers)
+    fun submit(req: Request, onResult: (Map<String, Any?>) -> Unit): Long {
+        return try {
+            nativeSubmitRequest(req) { _, result ->
+                onResult(toMap(result))
+            }
+        } catch (t: Throwable) {
+            onResult(errorResult(t))
+            0L
+        }
+    }
+
+    // Zero-copy variant of submit: onBody gets a direct ByteBuffer over native memory (null if the
+    // native side failed to allocate one), called on an engine thread
+    fun submitBody(req: Request, onBody: (ByteBuffer?) -> Unit): Long {
+        return try {
+            nativeSubmitBody(req) { _, buffer -> onBody(buffer) }
+        } catch (t: Throwable) {
+            onBody(null)
+            0L
+        }
+    }
+
+    fun freeBody(buffer: ByteBuffer) {
+        try {
+            nativeFreeBody(buffer)
+        } catch (_: Throwable) {
+        }
+    }
+
+    // Starts a streaming request; returns the token for streamAck/streamCancel (0 if it failed
+    // up front, in which case onDone has already been called)
+    fun stream(req: Request, windowBytes: Int, onChunk: (ByteArray) -> Unit, onDone: (Map<String, Any?>) -> Unit): Long {
+        return try {
+            nativeStreamSubmit(req, windowBytes, object : StreamCallback {
+                override fun onChunk(chunk: ByteArray) = onChunk(chunk)
+                override fun onComplete(result: Result?) = onDone(toMap(result))
+            })
+        } catch (t: Throwable) {
+            onDone(errorResult(t))
+            0L
+        }
+    }
+
+    fun streamAck(token: Long, bytes: Long) {
+        try {
+            nativeStreamAck(token, bytes)
+        } catch (_: Throwable) {
+        }
+    }
+
+    fun streamCancel(token: Long) {
+        try {
+            nativeStreamCancel(token)
+        } catch (_: Throwable) {
+        }
+    }
+
+    // Runs all requests concurrently in native code; blocks, results are in request order
+    fun batch(requests: List<Request>): List<Map<String, Any?>> {
+        if (requests.isEmpty()) return emptyList()
+        return try {
+            val results = nativeHttpBatch(requests.toTypedArray())
+            requests.indices.map { i -> toMap(results?.getOrNull(i)) }
+        } catch (t: Throwable) {
+            requests.map { errorResult(t) }
+        }
+    }
+
+    private fun toMap(r: Result?): Map<String, Any?> {
+        if (r == null) {
+            return mapOf("status" to null, "body" to "", "durationMs" to 0, "error" to "native error: no result")
+        }
+        return mapOf(
+            "status" to if (r.status >= 0) r.status else null,
+            "body" to (r.body?.toString(Charsets.UTF_8) ?: ""),
+            "durationMs" to r.durationMs,
+            "error" to r.error,
+            "errorCode" to r.errorCode,
+            "httpVersion" to r.httpVersion,
+            "headers" to headersMap(r.headers),
+            "timing" to r.timing?.let { t -> TIMING_KEYS.indices.filter { it < t.size }.associate { TIMING_KEYS[it] to t[it] } },
+        )
+    }
+
+    // Repeated names (set-cookie, ...) are joined with ", "
+    private fun headersMap(pairs: Array<String>?): Map<String, String>? {
+        if (pairs == null) return null
+        val map = LinkedHashMap<String, String>(pairs.size)
+        var i = 0
+        while (i + 1 < pairs.size) {
+            val name = pairs[i]
+            val prev = map[name]
+            map[name] = if (prev == null) pairs[i + 1] else prev + ", " + pairs[i + 1]
+            i += 2
+        }
+        return map
+    }
+
+    private fun errorResult(t: Throwable): Map<String, Any?> {
+        return mapOf(
+            "status" to null,
+            "body" to "",
+            "durationMs" to 0,
+            "error" to ("native error: " + t.toString()),
+        )
+    }
+
+    // Max concurrent HTTP/2 streams per connection on the native engine (0 = libcurl default)
+    fun setHttp2MaxStreams(maxStreams: Int) {
+        try {
+            nativeSetHttp2MaxStreams(maxStreams)
+        } catch (_: Throwable) {
+        }
+    }
+
+    // Native logcat floor: "verbose" | "debug" | "info" | "warn" | "error" | "off". Release
+    // builds compile verbose/debug out, so those only take effect in debug builds.
+    fun setLogLevel(level: String) {
+        val priority = when (level.lowercase()) {
+            "verbose" -> android.util.Log.VERBOSE
+            "debug" -> android.util.Log.DEBUG
+            "info" -> android.util.Log.INFO
+            "warn" -> android.util.Log.WARN
+            "error" -> android.util.Log.ERROR
+            "off" -> android.util.Log.ASSERT + 1
+            else -> return
+        }
+        try {
+            nativeSetLogLevel(priority)
+        } catch (_: Throwable) {
+        }
+    }
+
+    // Persists native TLS sessions to path so requests after an app restart can resume
+    fun sessionStoreOpen(path: String): Boolean {
+        return try {
+            nativeSessionStoreOpen(path)
+        } catch (_: Throwable) {
+            false
+        }
+    }
+
+    fun sessionStoreClear() {
+        try {
+            nativeSessionStoreClear()
+        } catch (_: Throwable) {
+        }
+    }
+
+    // Warms the native DNS cache (shared by curl and the pinning preflight) in the background
+    fun dnsPrefetch(hosts: List<String>) {
+        if (hosts.isEmpty()) return
+        try {
+            nativeDnsPrefetch(hosts.toTypedArray())
+        } catch (_: Throwable) {
+        }
+    }
+
+    // ttlSeconds <= 0 keeps the current TTL; disabling clears the cache
+    fun dnsConfigure(enabled: Boolean, ttlSeconds: Int) {
+        try {
+            nativeDnsConfigure(enabled, ttlSeconds)
+        } catch (_: Throwable) {
+        }
+    }
+
+    // Native stack counters (connection pool reuse etc.) as raw JSON
+    fun stats(): String {
+        return try {
+            nativeHttpStats()
+        } catch (t: Throwable) {
+            "{}"
         }
     }
 }
@@ -12,6 +12,35 @@ static size_t WriteCallback(void *contents, size_t size, size_t nmemb, void *use
     return realsize;
 }
 
+// Per-phase breakdown with the same keys as the Android native stack (see RequestTiming in
+// lab_screen.dart). Times are CURLINFO_*_TIME_T microseconds since the transfer started.
+static NSDictionary *TimingDictionary(CURL *curl) {
+    curl_off_t nameLookup = 0, connect = 0, appConnect = 0, preTransfer = 0, startTransfer = 0, total = 0;
+    curl_off_t uploaded = 0, downloaded = 0;
+    long connects = 0;
+    curl_easy_getinfo(curl, CURLINFO_NAMELOOKUP_TIME_T, &nameLookup);
+    curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME_T, &connect);
+    curl_easy_getinfo(curl, CURLINFO_APPCONNECT_TIME_T, &appConnect);
+    curl_easy_getinfo(curl, CURLINFO_PRETRANSFER_TIME_T, &preTransfer);
+    curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME_T, &startTransfer);
+    curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &total);
+    curl_easy_getinfo(curl, CURLINFO_SIZE_UPLOAD_T, &uploaded);
+    curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &downloaded);
+    curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &connects);
+    return @{
+        @"nameLookupUs": @((long long)nameLookup),
+        @"connectUs": @((long long)connect),
+        @"appConnectUs": @((long long)appConnect),
+        @"preTransferUs": @((long long)preTransfer),
+        @"startTransferUs": @((long long)startTransfer),
+        @"totalUs": @((long long)total),
+        @"pinCheckUs": @0, // no native pinning preflight on iOS
+        @"uploadBytes": @((long long)uploaded),
+        @"downloadBytes": @((long long)downloaded),
+        @"numConnects": @(connects)
+    };
+}
+
 @implementation NativeHttp
 
 + (NSDictionary *)performRequest:(NSString *)method
@@ -25,7 +54,7 @@ static size_t WriteCallback(void *contents, size_t size, size_t nmemb, void *use
     std::string readBuffer;
     long response_code = 0;
     std::string error_msg;
-    double total_time = 0;
+    curl_off_t total_time_us = 0;
 
     curl = curl_easy_init();
     if (!curl) {
@@ -90,13 +119,14 @@ static size_t WriteCallback(void *contents, size_t size, size_t nmemb, void *use
     // Perform request
     res = curl_easy_perform(curl);
 
-    // Get Info
+    // Get Info (timing is meaningful for failed transfers too)
     if (res == CURLE_OK) {
         curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
-        curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME, &total_time);
     } else {
         error_msg = curl_easy_strerror(res);
     }
+    curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &total_time_us);
+    NSDictionary *timing = TimingDictionary(curl);
 
     // Cleanup
     curl_easy_cleanup(curl);
@@ -109,16 +139,18 @@ static size_t WriteCallback(void *contents, size_t size, size_t nmemb, void *use
         return @{
             @"status": [NSNull null],
             @"body": @"",
-            @"durationMs": @((int)(total_time * 1000)),
-            @"error": [NSString stringWithUTF8String:error_msg.c_str()]
+            @"durationMs": @((int)(total_time_us / 1000)),
+            @"error": [NSString stringWithUTF8String:error_msg.c_str()],
+            @"timing": timing
         };
     }
 
     return @{
         @"status": @(response_code),
         @"body": [NSString stringWithUTF8String:readBuffer.c_str()] ?: @"",
-        @"durationMs": @((int)(total_time * 1000)),
-        @"error": [NSNull null]
+        @"durationMs": @((int)(total_time_us / 1000)),
+        @"error": [NSNull null],
+        @"timing": timing
     };
 }
 
@@ -51,17 +51,86 @@ class RequestConfig {
   static const Object _noUpdate = Object();
 }
 
+/// Per-phase breakdown reported by the native libcurl stacks. Times are
+/// microseconds since the transfer started (cumulative, as libcurl reports
+/// them); [pinCheckUs] is the native pinning preflight that runs before curl.
+class RequestTiming {
+  final int nameLookupUs;
+  final int connectUs;
+  final int appConnectUs; // TLS handshake finished (0 for plain http)
+  final int preTransferUs;
+  final int startTransferUs; // first response byte
+  final int totalUs;
+  final int pinCheckUs;
+  final int uploadBytes;
+  final int downloadBytes;
+  final int numConnects;
+  final int tlsResumed; // 1 resumed session, 0 full handshake, -1 unknown / plain http
+
+  const RequestTiming({
+    this.nameLookupUs = 0,
+    this.connectUs = 0,
+    this.appConnectUs = 0,
+    this.preTransferUs = 0,
+    this.startTransferUs = 0,
+    this.totalUs = 0,
+    this.pinCheckUs = 0,
+    this.uploadBytes = 0,
+    this.downloadBytes = 0,
+    this.numConnects = 0,
+    this.tlsResumed = -1,
+  });
+
+  factory RequestTiming.fromMap(Map<dynamic, dynamic> m) {
+    int v(String k) => (m[k] as num?)?.toInt() ?? 0;
+    return RequestTiming(
+      nameLookupUs: v('nameLookupUs'),
+      connectUs: v('connectUs'),
+      appConnectUs: v('appConnectUs'),
+      preTransferUs: v('preTransferUs'),
+      startTransferUs: v('startTransferUs'),
+      totalUs: v('totalUs'),
+      pinCheckUs: v('pinCheckUs'),
+      uploadBytes: v('uploadBytes'),
+      downloadBytes: v('downloadBytes'),
+      numConnects: v('numConnects'),
+      tlsResumed: (m['tlsResumed'] as num?)?.toInt() ?? -1,
+    );
+  }
+
+  @override
+  String toString() {
+    String ms(int us) => (us / 1000).toStringAsFixed(1);
+    final handshake = tlsResumed == 1
+        ? ' handshake=resumed'
+        : tlsResumed == 0
+            ? ' handshake=full'
+            : '';
+    return 'dns=${ms(nameLookupUs)} connect=${ms(connectUs)} tls=${ms(appConnectUs)} '
+        'ttfb=${ms(startTransferUs)} total=${ms(totalUs)} pin=${ms(pinCheckUs)}ms '
+        'up=${uploadBytes}B down=${downloadBytes}B conns=$numConnects$handshake';
+  }
+}
+
 class RequestResult {
   final int? status; // null bei hard error/timeout
   final String body;
   final String? error;
   final int durationMs;
+  final String? httpVersion; // negotiated protocol ("1.1", "2", ...) if the stack reports it
+  final Uint8List? bodyBytes; // raw body for binary requests; [body] is left empty then
+  final Map<String, String>? headers; // requested response headers (lowercase names)
+  final RequestTiming? timing; // native libcurl stacks only
 
   const RequestResult({
     required this.status,
     required this.body,
     required this.durationMs,
     this.error,
+    this.httpVersion,
+    this.bodyBytes,
+    this.headers,
+    this.timing,
   });
 
   bool get ok => error == null;
@@ -208,6 +277,7 @@ class LabController extends ChangeNotifier {
         appendLog(
           "<= DONE  ${s.name} | status=$statusStr | ${res.durationMs}ms$errStr",
         );
+        if (res.timing != null) appendLog("   timing ${res.timing}");
 
         // tiny pause so UI feels stable & logs render nicely
         await Future.delayed(const Duration(milliseconds: 150));
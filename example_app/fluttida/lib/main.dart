@@ -9,6 +9,7 @@ void main() async {
   MobileAds.instance.initialize();
   // Conditionally enable global HttpOverrides based on user preference
   await _initializeGlobalOverrides();
+  await _initializeNativeCurlConfig();
   runApp(const MyApp());
 }
 
@@ -26,6 +27,25 @@ Future<void> _initializeGlobalOverrides() async {
   }
 }
 
+// Re-applies the native curl settings saved on the settings page
+Future<void> _initializeNativeCurlConfig() async {
+  try {
+    final prefs = await SharedPreferences.getInstance();
+    final logLevel = prefs.getString('nativeCurl.logLevel');
+    final http2 = prefs.getBool('nativeCurl.http2');
+    final http2MaxStreams = prefs.getInt('nativeCurl.http2MaxStreams');
+    if (logLevel != null || http2 != null || http2MaxStreams != null) {
+      await StacksImpl.setNativeCurlConfig(
+        logLevel: logLevel,
+        http2: http2,
+        http2MaxStreams: http2MaxStreams,
+      );
+    }
+  } catch (_) {
+    // Native defaults stay in effect
+  }
+}
+
 class MyApp extends StatelessWidget {
   const MyApp({super.key});
 
@@ -11,6 +11,7 @@ enum PinningTechnique {
   curlPreflight, // Native curl: preflight OpenSSL probe only
   curlSslCtx, // Native curl: SSL_CTX verify callback only
   curlBoth, // Native curl: preflight + SSL_CTX
+  curlHandshake, // Native curl: check curl's own negotiated leaf before sending
 }
 
 // Per-stack pinning configuration
@@ -53,6 +54,8 @@ class StackPinConfig {
         return PinningTechnique.curlSslCtx;
       case 'curlBoth':
         return PinningTechnique.curlBoth;
+      case 'curlHandshake':
+        return PinningTechnique.curlHandshake;
       default:
         return PinningTechnique.postConnect;
     }
@@ -15,12 +15,16 @@ class _SettingsPageState extends State<SettingsPage> {
   PinningConfig _pinning = const PinningConfig.disabled();
   final TextEditingController _pinInputController = TextEditingController();
   bool _useGlobalOverride = false;
+  String _nativeLogLevel = StacksImpl.nativeLogLevelDefault;
+  bool _nativeHttp2 = false;
+  int _nativeHttp2MaxStreams = 0;
 
   @override
   void initState() {
     super.initState();
     _loadPinningConfig();
     _loadGlobalOverrideSetting();
+    _loadNativeCurlSettings();
   }
 
   @override
@@ -71,6 +75,53 @@ class _SettingsPageState extends State<SettingsPage> {
     }
   }
 
+  Future<void> _loadNativeCurlSettings() async {
+    try {
+      final prefs = await SharedPreferences.getInstance();
+      final level = prefs.getString('nativeCurl.logLevel');
+      final http2 = prefs.getBool('nativeCurl.http2');
+      final maxStreams = prefs.getInt('nativeCurl.http2MaxStreams');
+      if (!mounted) return;
+      setState(() {
+        if (level != null && StacksImpl.nativeLogLevels.contains(level)) {
+          _nativeLogLevel = level;
+        }
+        if (http2 != null) _nativeHttp2 = http2;
+        if (maxStreams != null &&
+            StacksImpl.nativeHttp2MaxStreamsOptions.contains(maxStreams)) {
+          _nativeHttp2MaxStreams = maxStreams;
+        }
+      });
+    } catch (_) {}
+  }
+
+  Future<void> _saveNativeLogLevel(String level) async {
+    setState(() => _nativeLogLevel = level);
+    try {
+      final prefs = await SharedPreferences.getInstance();
+      await prefs.setString('nativeCurl.logLevel', level);
+    } catch (_) {}
+    await StacksImpl.setNativeCurlConfig(logLevel: level);
+  }
+
+  Future<void> _saveNativeHttp2(bool enabled) async {
+    setState(() => _nativeHttp2 = enabled);
+    try {
+      final prefs = await SharedPreferences.getInstance();
+      await prefs.setBool('nativeCurl.http2', enabled);
+    } catch (_) {}
+    await StacksImpl.setNativeCurlConfig(http2: enabled);
+  }
+
+  Future<void> _saveNativeHttp2MaxStreams(int maxStreams) async {
+    setState(() => _nativeHttp2MaxStreams = maxStreams);
+    try {
+      final prefs = await SharedPreferences.getInstance();
+      await prefs.setInt('nativeCurl.http2MaxStreams', maxStreams);
+    } catch (_) {}
+    await StacksImpl.setNativeCurlConfig(http2MaxStreams: maxStreams);
+  }
+
   void _toggleStack(String key, bool enabled) {
     final stacks = Map<String, StackPinConfig>.from(_pinning.stacks);
     final existing = stacks[key] ?? const StackPinConfig.disabled();
@@ -310,6 +361,7 @@ class _SettingsPageState extends State<SettingsPage> {
                       PinningTechnique.curlPreflight,
                       PinningTechnique.curlSslCtx,
                       PinningTechnique.curlBoth,
+                      PinningTechnique.curlHandshake,
                     ],
                   ),
                   _buildStackRow(
@@ -385,6 +437,85 @@ class _SettingsPageState extends State<SettingsPage> {
               ),
             ),
           ),
+          const SizedBox(height: 12),
+          Card(
+            child: Padding(
+              padding: const EdgeInsets.all(12),
+              child: Column(
+                crossAxisAlignment: CrossAxisAlignment.start,
+                children: [
+                  const Text(
+                    'NDK libcurl',
+                    style: TextStyle(fontSize: 16, fontWeight: FontWeight.bold),
+                  ),
+                  const SizedBox(height: 8),
+                  Row(
+                    children: [
+                      const Expanded(
+                        child: Text(
+                          'Native log level',
+                          style: TextStyle(fontWeight: FontWeight.w500),
+                        ),
+                      ),
+                      DropdownButton<String>(
+                        isDense: true,
+                        value: _nativeLogLevel,
+                        items: StacksImpl.nativeLogLevels
+                            .map(
+                              (l) => DropdownMenuItem(value: l, child: Text(l)),
+                            )
+                            .toList(),
+                        onChanged: (v) {
+                          if (v != null) _saveNativeLogLevel(v);
+                        },
+                      ),
+                    ],
+                  ),
+                  Text(
+                    'Logcat floor for the native layer; release builds '
+                    'compile verbose and debug out.',
+                    style: Theme.of(context).textTheme.bodySmall,
+                  ),
+                  SwitchListTile(
+                    contentPadding: EdgeInsets.zero,
+                    title: const Text('HTTP/2'),
+                    subtitle: const Text(
+                      'Multiplexes concurrent requests to one origin',
+                    ),
+                    value: _nativeHttp2,
+                    onChanged: _saveNativeHttp2,
+                  ),
+                  Row(
+                    children: [
+                      const Expanded(
+                        child: Text(
+                          'Max streams per connection',
+                          style: TextStyle(fontWeight: FontWeight.w500),
+                        ),
+                      ),
+                      DropdownButton<int>(
+                        isDense: true,
+                        value: _nativeHttp2MaxStreams,
+                        items: StacksImpl.nativeHttp2MaxStreamsOptions
+                            .map(
+                              (n) => DropdownMenuItem(
+                                value: n,
+                                child: Text(n == 0 ? 'default' : '$n'),
+                              ),
+                            )
+                            .toList(),
+                        onChanged: _nativeHttp2
+                            ? (v) {
+                                if (v != null) _saveNativeHttp2MaxStreams(v);
+                              }
+                            : null,
+                      ),
+                    ],
+                  ),
+                ],
+              ),
+            ),
+          ),
         ],
       ),
     );
@@ -484,6 +615,8 @@ class _SettingsPageState extends State<SettingsPage> {
         return 'SSL_CTX Callback';
       case PinningTechnique.curlBoth:
         return 'Both';
+      case PinningTechnique.curlHandshake:
+        return 'Handshake';
     }
   }
 
@@ -1,6 +1,7 @@
 import 'dart:async';
 import 'dart:convert';
 import 'dart:io' as io;
+import 'dart:typed_data';
 
 import 'package:http/http.dart' as http;
 import 'package:http/io_client.dart';
@@ -18,6 +19,13 @@ import '../pinning/stacks/package_http_pinning.dart';
 
 class StacksImpl {
   static const MethodChannel _legacyChannel = MethodChannel('fluttida/network');
+  // Binary replies for native curl (see requestAndroidNativeCurlBytes)
+  static const BasicMessageChannel<ByteData> _nativeBodyChannel =
+      BasicMessageChannel<ByteData>('fluttida/native_body', BinaryCodec());
+  // Chunked native curl responses (see streamAndroidNativeCurl)
+  static const EventChannel _nativeStreamChannel = EventChannel(
+    'fluttida/native_stream',
+  );
   static void Function(String)? _logSink;
 
   static void setupLogChannel() {
@@ -25,6 +33,12 @@ class StacksImpl {
       if (call.method == 'log') {
         final msg = (call.arguments as Map?)?['message'] as String?;
         if (msg != null) _log(msg);
+      } else if (call.method == 'logBatch') {
+        // Native curl logs arrive in batches from the native log ring
+        final msgs = (call.arguments as Map?)?['messages'] as List?;
+        for (final m in msgs ?? const []) {
+          if (m is String) _log(m);
+        }
       }
     });
   }
@@ -56,6 +70,46 @@ class StacksImpl {
     }
   }
 
+  // Accepted setNativeCurlConfig(logLevel:) values; native default is 'info'
+  static const List<String> nativeLogLevels = [
+    'verbose',
+    'debug',
+    'info',
+    'warn',
+    'error',
+    'off',
+  ];
+  static const String nativeLogLevelDefault = 'info';
+
+  // setNativeCurlConfig(http2MaxStreams:) choices; 0 = libcurl default (100)
+  static const List<int> nativeHttp2MaxStreamsOptions = [0, 1, 8, 32, 100, 256];
+
+  // Native curl options: [http2] negotiates HTTP/2 and multiplexes concurrent
+  // requests to one origin; [http2MaxStreams] caps streams per connection.
+  // [logLevel] sets the native logcat floor ('verbose', 'debug', 'info', 'warn',
+  // 'error' or 'off'); release builds compile verbose/debug out.
+  static Future<void> setNativeCurlConfig({
+    bool? http2,
+    int? http2MaxStreams,
+    bool? dnsCache,
+    int? dnsTtlSeconds,
+    String? logLevel,
+    bool clearTlsSessions = false,
+  }) async {
+    try {
+      await _legacyChannel.invokeMethod('setNativeCurlConfig', {
+        if (http2 != null) 'http2': http2,
+        if (http2MaxStreams != null) 'http2MaxStreams': http2MaxStreams,
+        if (dnsCache != null) 'dnsCache': dnsCache,
+        if (dnsTtlSeconds != null) 'dnsTtlSeconds': dnsTtlSeconds,
+        if (logLevel != null) 'logLevel': logLevel,
+        if (clearTlsSessions) 'clearTlsSessions': true,
+      });
+    } catch (_) {
+      // Ignore: native handler may not be present
+    }
+  }
+
   static void setLogSink(void Function(String) sink) {
     _logSink = sink;
     GlobalHttpOverride.setLogSink(sink);
@@ -93,6 +147,13 @@ class StacksImpl {
       body: body,
       durationMs: durationMs,
       error: error,
+      httpVersion: map['httpVersion'] as String?,
+      headers: (map['headers'] as Map?)?.map(
+        (k, v) => MapEntry(k as String, v as String),
+      ),
+      timing: map['timing'] is Map
+          ? RequestTiming.fromMap(map['timing'] as Map)
+          : null,
     );
   }
 
@@ -436,9 +497,12 @@ class StacksImpl {
   // ---------------------------------------------------------------------------
   // Android native: NDK libcurl via JNI (MethodChannel)
   // ---------------------------------------------------------------------------
+  // [responseHeaders] names the response headers to return in
+  // RequestResult.headers ('*' for all); the rest are dropped natively.
   static Future<RequestResult> requestAndroidNativeCurl(
-    RequestConfig cfg,
-  ) async {
+    RequestConfig cfg, {
+    List<String>? responseHeaders,
+  }) async {
     if (!io.Platform.isAndroid) {
       return RequestResult(
         status: null,
@@ -455,6 +519,7 @@ class StacksImpl {
           'headers': cfg.headers,
           'body': cfg.body,
           'timeoutMs': cfg.timeout.inMilliseconds,
+          if (responseHeaders != null) 'responseHeaders': responseHeaders,
         });
 
     return _fromNativeMap(
@@ -463,6 +528,192 @@ class StacksImpl {
     );
   }
 
+  // Binary variant of requestAndroidNativeCurl: the body arrives as a Uint8List
+  // view over the reply (no String/JSON conversion on either side). The reply
+  // layout is little-endian: status, durationMs, errorCode, bodyLength,
+  // errorLength (int32 each), httpVersion (4 bytes, NUL padded), body, error.
+  static Future<RequestResult> requestAndroidNativeCurlBytes(
+    RequestConfig cfg,
+  ) async {
+    if (!io.Platform.isAndroid) {
+      return RequestResult(
+        status: null,
+        body: '',
+        durationMs: 0,
+        error: 'Android NDK (libcurl) is Android-only',
+      );
+    }
+
+    final args = utf8.encode(
+      jsonEncode({
+        'url': cfg.url,
+        'method': cfg.method,
+        'headers': cfg.headers,
+        'body': cfg.body,
+        'timeoutMs': cfg.timeout.inMilliseconds,
+      }),
+    );
+    final reply = await _nativeBodyChannel.send(ByteData.sublistView(args));
+    if (reply == null || reply.lengthInBytes < 24) {
+      return RequestResult(
+        status: null,
+        body: '',
+        durationMs: 0,
+        error: 'No response from native channel (NDK libcurl bytes).',
+      );
+    }
+
+    final status = reply.getInt32(0, Endian.little);
+    final durationMs = reply.getInt32(4, Endian.little);
+    final bodyLength = reply.getInt32(12, Endian.little);
+    final errorLength = reply.getInt32(16, Endian.little);
+    final version = Uint8List.view(reply.buffer, reply.offsetInBytes + 20, 4)
+        .takeWhile((b) => b != 0)
+        .toList();
+    final bytes = Uint8List.view(
+      reply.buffer,
+      reply.offsetInBytes + 24,
+      bodyLength,
+    );
+    final error = errorLength > 0
+        ? utf8.decode(
+            Uint8List.view(
+              reply.buffer,
+              reply.offsetInBytes + 24 + bodyLength,
+              errorLength,
+            ),
+            allowMalformed: true,
+          )
+        : null;
+    return RequestResult(
+      status: status >= 0 ? status : null,
+      body: '',
+      durationMs: durationMs,
+      error: error,
+      httpVersion: version.isEmpty ? null : String.fromCharCodes(version),
+      bodyBytes: bytes,
+    );
+  }
+
+  // Streams the response body of a native curl request chunk by chunk.
+  // The consumer calls [NativeCurlChunk.ack] once it has processed a chunk
+  // (e.g. written it out); when more than [windowBytes] are unacknowledged the
+  // native transfer pauses, so a slow consumer bounds memory instead of
+  // buffering the whole body. [onDone] receives the final result (its body is
+  // empty). Only one stream can be active at a time; listening again cancels
+  // the previous one.
+  static Stream<NativeCurlChunk> streamAndroidNativeCurl(
+    RequestConfig cfg, {
+    int windowBytes = 1024 * 1024,
+    void Function(RequestResult result)? onDone,
+  }) async* {
+    if (!io.Platform.isAndroid) {
+      onDone?.call(
+        RequestResult(
+          status: null,
+          body: '',
+          durationMs: 0,
+          error: 'Android NDK (libcurl) is Android-only',
+        ),
+      );
+      return;
+    }
+
+    final events = _nativeStreamChannel.receiveBroadcastStream({
+      'url': cfg.url,
+      'method': cfg.method,
+      'headers': cfg.headers,
+      'body': cfg.body,
+      'timeoutMs': cfg.timeout.inMilliseconds,
+      'windowBytes': windowBytes,
+    });
+    await for (final event in events) {
+      if (event is Uint8List) {
+        // yield does not wait for the listener's handler, so the window is
+        // only released when the consumer acks the chunk itself
+        yield NativeCurlChunk._(event, _ackNativeCurlStream);
+      } else if (event is Map) {
+        onDone?.call(_fromNativeMap(event));
+      }
+    }
+  }
+
+  static void _ackNativeCurlStream(int bytes) {
+    unawaited(
+      _legacyChannel
+          .invokeMethod('androidNativeCurlStreamAck', {'bytes': bytes})
+          .catchError((_) => null),
+    );
+  }
+
+  // Runs all configs concurrently inside native code with a single channel hop.
+  // Results are returned in the same order as [cfgs].
+  static Future<List<RequestResult>> requestAndroidNativeCurlBatch(
+    List<RequestConfig> cfgs, {
+    List<String>? responseHeaders,
+  }) async {
+    if (!io.Platform.isAndroid) {
+      return cfgs
+          .map(
+            (_) => RequestResult(
+              status: null,
+              body: '',
+              durationMs: 0,
+              error: 'Android NDK (libcurl) is Android-only',
+            ),
+          )
+          .toList();
+    }
+
+    final list = await _legacyChannel.invokeListMethod<dynamic>(
+      'androidNativeCurlBatch',
+      cfgs
+          .map(
+            (cfg) => {
+              'url': cfg.url,
+              'method': cfg.method,
+              'headers': cfg.headers,
+              'body': cfg.body,
+              'timeoutMs': cfg.timeout.inMilliseconds,
+              if (responseHeaders != null) 'responseHeaders': responseHeaders,
+            },
+          )
+          .toList(),
+    );
+
+    return List.generate(
+      cfgs.length,
+      (i) => _fromNativeMap(
+        (list != null && i < list.length) ? list[i] as Map? : null,
+        noResponseError: 'No response from native channel (NDK libcurl batch).',
+      ),
+    );
+  }
+
+  // Resolves [hosts] into the native DNS cache ahead of the first request.
+  static Future<void> androidNativeCurlDnsPrefetch(List<String> hosts) async {
+    if (!io.Platform.isAndroid || hosts.isEmpty) return;
+    try {
+      await _legacyChannel.invokeMethod('androidNativeCurlDnsPrefetch', hosts);
+    } catch (_) {
+      // Ignore: native handler may not be present
+    }
+  }
+
+  // Native libcurl counters (connection pool hits/misses, ...). Empty if unavailable.
+  static Future<Map<String, dynamic>> androidNativeCurlStats() async {
+    if (!io.Platform.isAndroid) return const {};
+    try {
+      final json = await _legacyChannel.invokeMethod<String>(
+        'androidNativeCurlStats',
+      );
+      if (json == null) return const {};
+      return (jsonDecode(json) as Map).cast<String, dynamic>();
+    } catch (_) {
+      return const {};
+    }
+  }
+
   // ---------------------------------------------------------------------------
   // 6) WebView headless (DOM outerHTML)
   // ---------------------------------------------------------------------------
@@ -630,3 +881,19 @@ class StacksImpl {
     }
   }
 }
+
+// One body chunk of [StacksImpl.streamAndroidNativeCurl]. [ack] hands its
+// bytes back to the native flow-control window; calling it again is a no-op.
+class NativeCurlChunk {
+  NativeCurlChunk._(this.bytes, this._onAck);
+
+  final Uint8List bytes;
+  final void Function(int bytes) _onAck;
+  bool _acked = false;
+
+  void ack() {
+    if (_acked) return;
+    _acked = true;
+    _onAck(bytes.length);
+  }
+}